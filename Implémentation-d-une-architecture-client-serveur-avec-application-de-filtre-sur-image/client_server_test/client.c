@@ -31,8 +31,8 @@ void cleanup_client(void) {
 
 int main(int argc, char *argv[]) {
   if (argc < 3) {
-    fprintf(stderr, "Usage: %s <chemin_image> <filtre_id> [param...]\n",
-        argv[0]);
+    fprintf(stderr, "Usage: %s <chemin_image> <filtre_id> "
+        "[geometrie_id [x y largeur hauteur]]\n", argv[0]);
     return EXIT_FAILURE;
   }
   atexit(cleanup_client);
@@ -41,10 +41,16 @@ int main(int argc, char *argv[]) {
     perror("mkfifo");
     return EXIT_FAILURE;
   }
+  int fd_fifo = open(fifo_path, O_RDONLY | O_NONBLOCK);
+  if (fd_fifo == -1) {
+    perror("open FIFO");
+    return EXIT_FAILURE;
+  }
   key_t key = ftok(".", SHM_REQUEST_KEY);
   shm_id = shmget(key, 0, 0);
   if (shm_id < 0) {
     fprintf(stderr, "Erreur: Serveur non détecté (SHM inaccessible).\n");
+    close(fd_fifo);
     return EXIT_FAILURE;
   }
   shm_ptr = (struct shm_request_segment *) shmat(shm_id, nullptr, 0);
@@ -52,13 +58,20 @@ int main(int argc, char *argv[]) {
   sem_t *sem_mutex = sem_open(SEM_MUTEX_NAME, 0);
   if (sem_req == SEM_FAILED || sem_mutex == SEM_FAILED) {
     perror("sem_open");
+    close(fd_fifo);
     return EXIT_FAILURE;
   }
-  struct filter_request req;
+  struct filter_request req = { 0 };
   req.pid = getpid();
   strncpy(req.chemin, argv[1], sizeof(req.chemin) - 1);
   req.chemin[sizeof(req.chemin) - 1] = '\0';
   req.filtre = atoi(argv[2]);
+  if (argc > 3) {
+    req.geometrie = atoi(argv[3]);
+  }
+  for (int i = 4; i < argc && i - 4 < 5; i++) {
+    req.parametres[i - 4] = atoi(argv[i]);
+  }
   sem_wait(sem_mutex);
   int idx = shm_ptr->write_index;
   shm_ptr->requests[idx] = req;
@@ -69,14 +82,10 @@ int main(int argc, char *argv[]) {
   sem_post(sem_req);
   sem_close(sem_req);
   sem_close(sem_mutex);
-  int fd_fifo = open(fifo_path, O_RDONLY | O_NONBLOCK);
-  if (fd_fifo == -1) {
-    perror("open FIFO");
-    return EXIT_FAILURE;
-  }
   struct pollfd pfd = { .fd = fd_fifo, .events = POLLIN };
-  printf("Client[%d]: Attente des données (timeout 5s)...\n", getpid());
-  int ret = poll(&pfd, 1, 5000);
+  printf("Client[%d]: Attente des données (timeout %ds)...\n", getpid(),
+      REPLY_TIMEOUT_MS / 1000);
+  int ret = poll(&pfd, 1, REPLY_TIMEOUT_MS);
   if (ret <= 0) {
     if (ret == 0) {
       fprintf(stderr,
@@ -89,6 +98,30 @@ int main(int argc, char *argv[]) {
   }
   int flags = fcntl(fd_fifo, F_GETFL, 0);
   fcntl(fd_fifo, F_SETFL, flags & ~O_NONBLOCK);
+  struct filter_reply reply;
+  if (read(fd_fifo, &reply, sizeof(reply)) != (ssize_t) sizeof(reply)) {
+    fprintf(stderr, "Erreur : Réponse du serveur incomplète.\n");
+    close(fd_fifo);
+    return EXIT_FAILURE;
+  }
+  if (reply.status != REPLY_OK) {
+    switch (reply.status) {
+      case REPLY_BUSY:
+        fprintf(stderr, "Erreur : Serveur surchargé, réessayez plus tard.\n");
+        break;
+      case REPLY_TOO_LARGE:
+        fprintf(stderr, "Erreur : Image trop volumineuse pour le serveur.\n");
+        break;
+      case REPLY_INVALID:
+        fprintf(stderr, "Erreur : Image illisible ou non BMP.\n");
+        break;
+      default:
+        fprintf(stderr, "Erreur : Statut de réponse %d inconnu.\n",
+            reply.status);
+    }
+    close(fd_fifo);
+    return EXIT_FAILURE;
+  }
   FILE *output_file = fopen("result.bmp", "wb");
   if (!output_file) {
     perror("fopen result.bmp");
@@ -8,6 +8,10 @@
 //      d'une nouvelle requête ;
 //  - la réception du résultat s'effectue via un tube nommé (FIFO) dont le
 //      nom est basé sur le PID du processus client pour garantir l'unicité ;
+//      la FIFO est ouverte avant le dépôt de la requête afin que le serveur
+//      puisse y écrire sans blocage une réponse de refus ;
+//  - la réponse débute par une struct filter_reply : seule une réponse
+//      REPLY_OK est suivie de l'image, les autres statuts sont affichés ;
 //  - la fonction cleanup_client assure la libération systématique des
 //      ressources IPC et la suppression de la FIFO en fin d'exécution ;
 //  - le module stocke l'image résultante localement sous le nom « result.bmp ».
@@ -17,6 +21,12 @@
 
 #include "common.h"
 
+//- PARAMÈTRES --v---v---v---v---v---v---v---v---v---v---v---v---v---v---v---v-
+
+//  REPLY_TIMEOUT_MS : délai d'attente maximal de la réponse. Il couvre le
+//    séjour éventuel de la requête dans la file d'attente du serveur.
+#define REPLY_TIMEOUT_MS 30000
+
 //- PROCÉDURES DU MODULE --v---v---v---v---v---v---v---v---v---v---v---v---v---v
 
 //  cleanup_client : libère les ressources de mémoire partagée (shmdt) et
@@ -25,10 +35,13 @@
 //    systématique à la fermeture du programme.
 extern void cleanup_client(void);
 
-//  main : point d'entrée principal du programme client. Orchestre l'ouverture
-//    des IPC, le dépôt de la requête struct filter_request dans le segment SHM,
-//    la notification du serveur via le sémaphore SEM_NAME et la reconstruction
-//    du fichier BMP final reçu par la FIFO.
+//  main : point d'entrée principal du programme client. Lit le chemin de
+//    l'image, le filtre (FILTER_NONE à FILTER_BRIGHTNESS), puis éventuellement
+//    la transformation géométrique (GEOM_*) et ses paramètres de recadrage.
+//    Orchestre l'ouverture des IPC, le dépôt de la requête struct
+//    filter_request dans le segment SHM, la notification du serveur via le
+//    sémaphore SEM_NAME et la reconstruction du fichier BMP final reçu par la
+//    FIFO.
 int main(int argc, char *argv[]);
 
 #endif
@@ -10,13 +10,35 @@
 #include <fcntl.h>
 #include <string.h>
 #include <semaphore.h>
+#include <time.h>
 
 #include "server.h"
+#include "image_ops.h"
 
 int shm_id = -1;
 struct shm_request_segment *shm_ptr = nullptr;
 sem_t *sem_req = nullptr;
 sem_t *sem_mutex = nullptr;
+int owns_resources = 1;
+int lock_fd = -1;
+pid_t predecessor_pid = 0;
+
+struct server_config config = {
+  .num_threads = NUM_THREADS,
+  .max_workers = MAX_WORKERS,
+  .memory_budget = MEMORY_BUDGET,
+};
+
+volatile sig_atomic_t reload_requested = 0;
+volatile sig_atomic_t handover_requested = 0;
+
+struct worker_slot active_workers[WORKERS_LIMIT];
+int active_count = 0;
+size_t memory_in_use = 0;
+
+struct pending_request pending_queue[PENDING_QUEUE_SIZE];
+int pending_head = 0;
+int pending_count = 0;
 
 //- GESTION DES RESSOURCES --v---v---v---v---v---v---v---v---v---v---v---v---v--
 
@@ -24,6 +46,12 @@ void cleanup(void) {
   if (shm_ptr != nullptr && shm_ptr != (void *) -1) {
     shmdt(shm_ptr);
   }
+  if (!owns_resources) {
+    sem_close(sem_req);
+    sem_close(sem_mutex);
+    fprintf(stderr, "Serveur: Relais terminé, ressources conservées.\n");
+    return;
+  }
   if (shm_id != -1) {
     shmctl(shm_id, IPC_RMID, nullptr);
     fprintf(stderr, "Serveur: SHM libérée.\n");
@@ -58,6 +86,183 @@ void init_resources(void) {
   }
 }
 
+void attach_resources(void) {
+  key_t key = ftok(".", SHM_REQUEST_KEY);
+  shm_id = shmget(key, 0, 0);
+  if (shm_id < 0) {
+    fprintf(stderr, "Serveur: Aucune instance à relayer (SHM absente).\n");
+    exit(EXIT_FAILURE);
+  }
+  struct shmid_ds ds;
+  if (shmctl(shm_id, IPC_STAT, &ds) == -1) {
+    perror("shmctl");
+    exit(EXIT_FAILURE);
+  }
+  if (ds.shm_segsz != sizeof(struct shm_request_segment)) {
+    fprintf(stderr, "Serveur: Segment de requêtes incompatible (%zu octets, "
+        "%zu attendus), relais refusé.\n", (size_t) ds.shm_segsz,
+        sizeof(struct shm_request_segment));
+    exit(EXIT_FAILURE);
+  }
+  shm_ptr = (struct shm_request_segment *) shmat(shm_id, nullptr, 0);
+  if (shm_ptr == (void *) -1) {
+    perror("shmat");
+    exit(EXIT_FAILURE);
+  }
+  sem_req = sem_open(SEM_NAME, 0);
+  sem_mutex = sem_open(SEM_MUTEX_NAME, 0);
+  if (sem_req == SEM_FAILED || sem_mutex == SEM_FAILED) {
+    perror("sem_open");
+    exit(EXIT_FAILURE);
+  }
+}
+
+void load_config(void) {
+  FILE *f = fopen(SERVER_CONF_PATH, "r");
+  if (f == nullptr) {
+    return;
+  }
+  struct server_config next = config;
+  char line[128];
+  while (fgets(line, sizeof(line), f) != nullptr) {
+    char cle[32];
+    long valeur;
+    if (line[0] == '#' || sscanf(line, " %31[^= ] = %ld", cle, &valeur) != 2) {
+      continue;
+    }
+    if (strcmp(cle, "threads") == 0 && valeur >= 1 && valeur <= THREADS_LIMIT) {
+      next.num_threads = (int) valeur;
+    } else if (strcmp(cle, "workers") == 0 && valeur >= 1
+        && valeur <= WORKERS_LIMIT) {
+      next.max_workers = (int) valeur;
+    } else if (strcmp(cle, "budget_mo") == 0 && valeur >= 1
+        && valeur <= BUDGET_MO_LIMIT) {
+      next.memory_budget = (size_t) valeur * 1024 * 1024;
+    } else {
+      fprintf(stderr, "Serveur: Paramètre ignoré : %s", line);
+    }
+  }
+  fclose(f);
+  config = next;
+  fprintf(stderr, "Serveur: Configuration : %d threads, %d workers, %zu Mo.\n",
+      config.num_threads, config.max_workers,
+      config.memory_budget / (1024 * 1024));
+}
+
+//- CONTRÔLE D'ADMISSION --v---v---v---v---v---v---v---v---v---v---v---v---v---
+
+//  fits_budget : indique si un Worker d'empreinte footprint peut démarrer
+//    immédiatement sans dépasser MAX_WORKERS ni MEMORY_BUDGET. Aucun Worker
+//    ne démarre tant que l'instance relayée n'a pas terminé les siens.
+static int fits_budget(size_t footprint) {
+  return predecessor_pid == 0
+    && active_count < config.max_workers
+    && memory_in_use + footprint <= config.memory_budget;
+}
+
+//  spawn_worker : crée le processus Worker chargé de req et lui réserve
+//    footprint octets du budget. Renvoie 0 en cas de succès, -1 si fork échoue.
+static int spawn_worker(struct filter_request req, size_t footprint) {
+  pid_t pid = fork();
+  if (pid < 0) {
+    perror("fork");
+    return -1;
+  }
+  if (pid == 0) {
+    sem_close(sem_req);
+    sem_close(sem_mutex);
+    worker_process(req, config.num_threads);
+    _exit(EXIT_SUCCESS);
+  }
+  active_workers[active_count].pid = pid;
+  active_workers[active_count].footprint = footprint;
+  active_workers[active_count].started = time(nullptr);
+  active_count++;
+  memory_in_use += footprint;
+  return 0;
+}
+
+void reap_workers(void) {
+  pid_t pid;
+  while ((pid = waitpid(-1, nullptr, WNOHANG)) > 0) {
+    for (int i = 0; i < active_count; i++) {
+      if (active_workers[i].pid == pid) {
+        memory_in_use -= active_workers[i].footprint;
+        active_workers[i] = active_workers[--active_count];
+        break;
+      }
+    }
+  }
+}
+
+void expire_workers(void) {
+  time_t now = time(nullptr);
+  for (int i = 0; i < active_count; i++) {
+    if (now - active_workers[i].started >= WORKER_TIMEOUT_S) {
+      fprintf(stderr, "Serveur: Worker %d hors délai, arrêt forcé.\n",
+          active_workers[i].pid);
+      kill(active_workers[i].pid, SIGKILL);
+    }
+  }
+}
+
+void dispatch_pending(void) {
+  while (pending_count > 0) {
+    struct pending_request *p = &pending_queue[pending_head];
+    if (!fits_budget(p->footprint)) {
+      return;
+    }
+    if (kill(p->req.pid, 0) == -1 && errno == ESRCH) {
+      fprintf(stderr, "Serveur: Client %d disparu, requête abandonnée.\n",
+          p->req.pid);
+    } else if (spawn_worker(p->req, p->footprint) != 0) {
+      send_reply_status(p->req.pid, REPLY_BUSY);
+    }
+    pending_head = (pending_head + 1) % PENDING_QUEUE_SIZE;
+    pending_count--;
+  }
+}
+
+void admit_request(struct filter_request req) {
+  if (req.filtre < FILTER_NONE || req.filtre > FILTER_BRIGHTNESS
+      || req.geometrie < GEOM_NONE || req.geometrie > GEOM_CROP) {
+    send_reply_status(req.pid, REPLY_INVALID);
+    return;
+  }
+  size_t footprint;
+  size_t rotated_footprint;
+  if (bmp_shm_footprint(req.chemin, &footprint, &rotated_footprint) != 0) {
+    send_reply_status(req.pid, REPLY_INVALID);
+    return;
+  }
+  if (footprint > sizeof(struct image_data) + (size_t) MAX_IMAGE_SIZE) {
+    send_reply_status(req.pid, REPLY_TOO_LARGE);
+    return;
+  }
+  if (req.geometrie == GEOM_ROTATE_90 || req.geometrie == GEOM_ROTATE_270) {
+    footprint += rotated_footprint;
+  }
+  if (footprint > config.memory_budget) {
+    send_reply_status(req.pid, REPLY_TOO_LARGE);
+    return;
+  }
+  if (pending_count == 0 && fits_budget(footprint)) {
+    if (spawn_worker(req, footprint) != 0) {
+      send_reply_status(req.pid, REPLY_BUSY);
+    }
+    return;
+  }
+  if (pending_count == PENDING_QUEUE_SIZE) {
+    fprintf(stderr, "Serveur: Surcharge, requête de %d rejetée.\n", req.pid);
+    send_reply_status(req.pid, REPLY_BUSY);
+    return;
+  }
+  int tail = (pending_head + pending_count) % PENDING_QUEUE_SIZE;
+  pending_queue[tail].req = req;
+  pending_queue[tail].footprint = footprint;
+  pending_count++;
+}
+
 //- SYSTÈME ET SIGNAUX --v---v---v---v---v---v---v---v---v---v---v---v---v---v--
 
 void daemonize(void) {
@@ -80,41 +285,242 @@ void daemonize(void) {
 
 void sigchld_handler(int signum) {
   (void) signum;
-  while (waitpid(-1, nullptr, WNOHANG) > 0) {
+}
+
+void control_signal_handler(int signum) {
+  if (signum == SIGHUP) {
+    reload_requested = 1;
+  } else if (signum == SIGUSR1) {
+    handover_requested = 1;
+  }
+}
+
+//- RELAIS ENTRE INSTANCES --v---v---v---v---v---v---v---v---v---v---v---v---v--
+
+//  lock_request : construit la description d'un verrou de type type sur
+//    l'octet offset de SERVER_LOCK_PATH.
+static struct flock lock_request(short type, off_t offset) {
+  struct flock fl;
+  memset(&fl, 0, sizeof(fl));
+  fl.l_type = type;
+  fl.l_whence = SEEK_SET;
+  fl.l_start = offset;
+  fl.l_len = 1;
+  return fl;
+}
+
+//  lock_holder : renvoie le PID du détenteur du verrou de l'octet offset, 0
+//    s'il est libre ou -1 en cas d'erreur.
+static pid_t lock_holder(off_t offset) {
+  struct flock fl = lock_request(F_WRLCK, offset);
+  if (fcntl(lock_fd, F_GETLK, &fl) == -1) {
+    perror("Serveur: Verrou (F_GETLK)");
+    return -1;
   }
+  return fl.l_type == F_UNLCK ? 0 : fl.l_pid;
+}
+
+//  queue_successor : envoie SIGUSR1 à l'instance qui attendait déjà la
+//    relève, puis prend à sa place le verrou LOCK_SUCCESSOR dès qu'elle l'a
+//    libéré.
+static void queue_successor(void) {
+  pid_t waiting = lock_holder(LOCK_SUCCESSOR);
+  if (waiting > 0 && kill(waiting, SIGUSR1) == 0) {
+    fprintf(stderr, "Serveur: Remplacement de l'instance en attente %d.\n",
+        waiting);
+  }
+  struct flock fl = lock_request(F_WRLCK, LOCK_SUCCESSOR);
+  while (fcntl(lock_fd, F_SETLKW, &fl) == -1) {
+    if (errno != EINTR) {
+      perror("Serveur: Verrou (F_SETLKW)");
+      exit(EXIT_FAILURE);
+    }
+  }
+}
+
+pid_t open_lock(void) {
+  lock_fd = open(SERVER_LOCK_PATH, O_RDWR | O_CREAT, 0644);
+  if (lock_fd == -1) {
+    perror("Serveur: " SERVER_LOCK_PATH);
+    exit(EXIT_FAILURE);
+  }
+  pid_t holder = lock_holder(LOCK_ACTIVE);
+  if (holder == -1) {
+    exit(EXIT_FAILURE);
+  }
+  return holder;
+}
+
+//  relay : envoie SIGUSR1 à l'instance holder, détentrice du verrou, et
+//    diffère le lancement des Workers jusqu'à sa terminaison.
+static void relay(pid_t holder) {
+  if (kill(holder, SIGUSR1) == -1) {
+    perror("Serveur: Relais (kill)");
+    exit(EXIT_FAILURE);
+  }
+  predecessor_pid = holder;
+  fprintf(stderr, "Serveur: Relève de l'instance %d.\n", holder);
+}
+
+void take_over(void) {
+  struct flock fl = lock_request(F_WRLCK, LOCK_ACTIVE);
+  if (fcntl(lock_fd, F_SETLK, &fl) == 0) {
+    return;
+  }
+  queue_successor();
+  pid_t holder;
+  while ((holder = lock_holder(LOCK_ACTIVE)) == 0) {
+    if (fcntl(lock_fd, F_SETLK, &fl) == 0) {
+      struct flock unlock = lock_request(F_UNLCK, LOCK_SUCCESSOR);
+      fcntl(lock_fd, F_SETLK, &unlock);
+      return;
+    }
+  }
+  if (holder == -1) {
+    exit(EXIT_FAILURE);
+  }
+  relay(holder);
+}
+
+void check_predecessor(void) {
+  struct flock fl = lock_request(F_WRLCK, LOCK_ACTIVE);
+  if (fcntl(lock_fd, F_SETLK, &fl) == 0) {
+    struct flock unlock = lock_request(F_UNLCK, LOCK_SUCCESSOR);
+    fcntl(lock_fd, F_SETLK, &unlock);
+    fprintf(stderr, "Serveur: Instance %d terminée, admission ouverte.\n",
+        predecessor_pid);
+    predecessor_pid = 0;
+    return;
+  }
+  pid_t holder = lock_holder(LOCK_ACTIVE);
+  if (holder > 0 && holder != predecessor_pid) {
+    relay(holder);
+  }
+}
+
+//  abandon_workers : tue les Workers encore actifs, attend leur fin et
+//    restitue leur part du budget.
+static void abandon_workers(void) {
+  fprintf(stderr, "Serveur: Délai de relais dépassé, arrêt forcé de %d "
+      "workers.\n", active_count);
+  for (; active_count > 0; active_count--) {
+    struct worker_slot *w = &active_workers[active_count - 1];
+    kill(w->pid, SIGKILL);
+    while (waitpid(w->pid, nullptr, 0) == -1 && errno == EINTR) {
+    }
+    memory_in_use -= w->footprint;
+  }
+}
+
+void drain_and_exit(void) {
+  owns_resources = 0;
+  fprintf(stderr, "Serveur: Relais, fin des %d workers et %d requêtes en "
+      "attente.\n", active_count, pending_count);
+  struct sigaction sa;
+  sa.sa_handler = sigchld_handler;
+  sigemptyset(&sa.sa_mask);
+  sa.sa_flags = 0;
+  sigaction(SIGALRM, &sa, nullptr);
+  sigset_t chld_mask;
+  sigset_t wait_mask;
+  sigemptyset(&chld_mask);
+  sigaddset(&chld_mask, SIGCHLD);
+  sigaddset(&chld_mask, SIGALRM);
+  sigprocmask(SIG_BLOCK, &chld_mask, &wait_mask);
+  time_t deadline = time(nullptr) + DRAIN_TIMEOUT_S;
+  reap_workers();
+  dispatch_pending();
+  while (active_count > 0) {
+    time_t left = deadline - time(nullptr);
+    if (left <= 0) {
+      break;
+    }
+    alarm((unsigned int) left);
+    sigsuspend(&wait_mask);
+    reap_workers();
+    expire_workers();
+    dispatch_pending();
+  }
+  alarm(0);
+  if (active_count > 0) {
+    abandon_workers();
+  }
+  for (; pending_count > 0; pending_count--) {
+    send_reply_status(pending_queue[pending_head].req.pid, REPLY_BUSY);
+    pending_head = (pending_head + 1) % PENDING_QUEUE_SIZE;
+  }
+  exit(EXIT_SUCCESS);
+}
+
+//  pop_request : retire la plus ancienne requête du tampon circulaire. Le
+//    verrou SEM_MUTEX_NAME est pris car deux instances consomment le tampon
+//    pendant un relais.
+static struct filter_request pop_request(void) {
+  while (sem_wait(sem_mutex) == -1 && errno == EINTR) {
+  }
+  struct filter_request req = shm_ptr->requests[shm_ptr->read_index];
+  shm_ptr->read_index = (shm_ptr->read_index + 1) % (int) MAX_REQUESTS;
+  sem_post(sem_mutex);
+  return req;
 }
 
 //- POINT D'ENTRÉE --v---v---v---v---v---v---v---v---v---v---v---v---v---v---v--
 
 int main(int argc, char *argv[]) {
-  (void) argc;
-  (void) argv;
+  int reprise = argc > 1 && strcmp(argv[1], "--reprise") == 0;
+  if (argc > 2 || (argc == 2 && !reprise)) {
+    fprintf(stderr, "Usage: %s [--reprise]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
   struct sigaction sa;
   sa.sa_handler = sigchld_handler;
   sigemptyset(&sa.sa_mask);
-  sa.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+  sa.sa_flags = SA_NOCLDSTOP; // Sans SA_RESTART : sem_wait rend EINTR
   sigaction(SIGCHLD, &sa, nullptr);
-  init_resources();
+  sa.sa_handler = control_signal_handler;
+  sa.sa_flags = 0;
+  sigaction(SIGHUP, &sa, nullptr);
+  sigaction(SIGUSR1, &sa, nullptr);
+  load_config();
+  pid_t holder = open_lock();
+  if (reprise) {
+    attach_resources();
+  } else if (holder > 0) {
+    fprintf(stderr, "Serveur: Instance %d active, utiliser --reprise.\n",
+        holder);
+    return EXIT_FAILURE;
+  } else {
+    init_resources();
+  }
   daemonize();
   atexit(cleanup);
+  take_over();
   fprintf(stderr, "Serveur: En attente de requêtes...\n");
   while (1) {
-    if (sem_wait(sem_req) == -1) {
-      if (errno == EINTR) {
+    if (handover_requested) {
+      drain_and_exit();
+    }
+    if (reload_requested) {
+      reload_requested = 0;
+      load_config();
+    }
+    if (predecessor_pid > 0) {
+      check_predecessor();
+    }
+    reap_workers();
+    expire_workers();
+    dispatch_pending();
+    struct timespec deadline = { .tv_sec = time(nullptr) + ADMISSION_RETRY_S };
+    if (sem_timedwait(sem_req, &deadline) == -1) {
+      if (errno == EINTR || errno == ETIMEDOUT) {
         continue;
       }
-      perror("sem_wait");
+      perror("sem_timedwait");
       break;
     }
-    struct filter_request req = shm_ptr->requests[shm_ptr->read_index];
-    shm_ptr->read_index = (shm_ptr->read_index + 1) % (int) MAX_REQUESTS;
-    pid_t pid = fork();
-    if (pid == 0) {
-      sem_close(sem_req);
-      sem_close(sem_mutex);
-      worker_process(req);
-      _exit(EXIT_SUCCESS);
-    }
+    struct filter_request req = pop_request();
+    reap_workers();
+    admit_request(req);
   }
   return 0;
 }
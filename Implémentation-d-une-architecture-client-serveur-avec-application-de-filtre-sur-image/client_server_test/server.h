@@ -8,10 +8,30 @@
 //  - il implémente une boucle de consommation passive : le processus s'endort
 //      sur un sémaphore et ne consomme aucun cycle CPU tant qu'aucune requête
 //      n'est déposée par un client ;
-//  - pour chaque requête, il génère un processus fils (Worker) via fork()
+//  - pour chaque requête, il estime l'empreinte mémoire de l'image à partir
+//      de ses seuls en-têtes BMP avant tout fork : la requête est lancée si le
+//      budget (MAX_WORKERS, MEMORY_BUDGET) le permet, mise en attente sinon,
+//      ou rejetée par une réponse explicite si la file d'attente est pleine ;
+//  - chaque requête admise est confiée à un processus fils (Worker) via fork()
 //      garantissant l'isolation des traitements ;
 //  - il assure le nettoyage automatique des ressources système lors de sa
-//      fermeture (suppression de la SHM et du sémaphore).
+//      fermeture (suppression de la SHM et du sémaphore) ;
+//  - l'instance active détient un verrou fcntl sur SERVER_LOCK_PATH ; lancé
+//      avec l'option --reprise, le serveur s'attache au tampon et aux
+//      sémaphores existants au lieu de les recréer, puis envoie SIGUSR1 au
+//      détenteur du verrou : l'ancienne instance cesse de consommer le
+//      tampon, termine ses Workers et sa file d'attente, puis quitte sans
+//      supprimer les IPC. La nouvelle instance consomme le tampon dès son
+//      lancement mais ne lance aucun Worker avant d'avoir obtenu le verrou,
+//      de sorte que MAX_WORKERS et MEMORY_BUDGET restent globaux ;
+//  - si une instance attend déjà la relève lorsqu'une autre est lancée avec
+//      --reprise, la plus récente lui envoie aussi SIGUSR1 : l'instance en
+//      attente rejette sa file d'attente par REPLY_BUSY et quitte, de sorte
+//      que le dernier déploiement l'emporte ;
+//  - SIGHUP relit le fichier SERVER_CONF_PATH (threads, workers, budget_mo)
+//      sans toucher aux requêtes en cours ou en attente ;
+//  - la SHM étant identifiée par ftok(".", ...), toutes les instances et les
+//      clients doivent être lancés depuis le même répertoire.
 
 #ifndef SERVER__H
 #define SERVER__H
@@ -19,6 +39,87 @@
 #include "common.h"
 #include "worker.h" // Nécessaire pour worker_process
 
+//- PARAMÈTRES D'ADMISSION --v---v---v---v---v---v---v---v---v---v---v---v---v-
+
+//  MAX_WORKERS : nombre maximal par défaut de processus Workers actifs
+//    simultanément, modifiable par la clé « workers » de SERVER_CONF_PATH.
+#define MAX_WORKERS 4
+
+//  WORKERS_LIMIT : borne supérieure de la clé « workers ».
+#define WORKERS_LIMIT 64
+
+//  MEMORY_BUDGET : somme maximale par défaut (256 Mo) des segments SHM
+//    d'images alloués par les Workers actifs, modifiable par la clé
+//    « budget_mo ».
+#define MEMORY_BUDGET (256 * 1024 * 1024)
+
+//  BUDGET_MO_LIMIT : borne supérieure de la clé « budget_mo ».
+#define BUDGET_MO_LIMIT (64 * 1024)
+
+//  PENDING_QUEUE_SIZE : nombre de requêtes admises mises en attente de budget
+//    au-delà duquel le serveur répond REPLY_BUSY.
+#define PENDING_QUEUE_SIZE 16
+
+//  WORKER_TIMEOUT_S : durée maximale (secondes) pendant laquelle un Worker
+//    conserve sa part du budget. Au-delà, il est tué par SIGKILL, par exemple
+//    lorsque son client a cessé de lire la FIFO.
+#define WORKER_TIMEOUT_S 60
+
+//  ADMISSION_RETRY_S : durée maximale (secondes) d'une attente sur le
+//    sémaphore. Borne le délai de prise en compte d'un signal reçu juste
+//    avant l'attente et le réexamen de la file d'attente, ainsi que la
+//    détection de la fin de l'instance relayée.
+#define ADMISSION_RETRY_S 1
+
+//  DRAIN_TIMEOUT_S : durée maximale (secondes) accordée par une instance
+//    relayée à ses Workers et à sa file d'attente. Au-delà, les Workers
+//    restants sont tués et les requêtes en attente rejetées, afin qu'un
+//    Worker bloqué ne retienne pas indéfiniment la nouvelle instance.
+#define DRAIN_TIMEOUT_S 30
+
+//- CONFIGURATION --v---v---v---v---v---v---v---v---v---v---v---v---v---v---v--
+
+//  SERVER_CONF_PATH : fichier de configuration relu au démarrage et à chaque
+//    SIGHUP. Une ligne « cle=valeur » par paramètre ; les lignes débutant par
+//    '#' sont ignorées. Clés : threads, workers, budget_mo.
+#define SERVER_CONF_PATH "serveur.conf"
+
+//  SERVER_LOCK_PATH : fichier portant les verrous en écriture LOCK_ACTIVE et
+//    LOCK_SUCCESSOR. Le noyau associe chaque verrou au PID de son détenteur
+//    et le libère à la fin du processus : le PID à relayer est ainsi vérifié
+//    et la fin de l'ancienne instance est observable.
+#define SERVER_LOCK_PATH "serveur.lock"
+
+//  LOCK_ACTIVE : octet de SERVER_LOCK_PATH verrouillé par l'instance active.
+#define LOCK_ACTIVE 0
+
+//  LOCK_SUCCESSOR : octet de SERVER_LOCK_PATH verrouillé par l'instance qui
+//    attend la fin de l'instance active. Une seule instance attend à la
+//    fois : la plus récente écarte la précédente, de sorte que le dernier
+//    déploiement l'emporte lors de relances rapprochées.
+#define LOCK_SUCCESSOR 1
+
+//  struct server_config : paramètres d'exécution rechargeables.
+struct server_config {
+  int num_threads;
+  int max_workers;
+  size_t memory_budget;
+};
+
+//  struct worker_slot : Worker actif, part du budget mémoire qu'il occupe et
+//    date de son lancement.
+struct worker_slot {
+  pid_t pid;
+  size_t footprint;
+  time_t started;
+};
+
+//  struct pending_request : requête admise en attente de budget.
+struct pending_request {
+  struct filter_request req;
+  size_t footprint;
+};
+
 //- PROCÉDURES DU MODULE --v---v---v---v---v---v---v---v---v---v---v---v---v---v
 
 //  cleanup : libère le segment de mémoire partagée et ferme/supprime le
@@ -30,19 +131,82 @@ extern void cleanup(void);
 //    s'arrête avec un message d'erreur.
 extern void init_resources(void);
 
+//  attach_resources : s'attache au segment de mémoire partagée et aux
+//    sémaphores d'une instance en cours sans modifier le tampon circulaire.
+//    Le relais est refusé si la taille du segment ne correspond pas à
+//    struct shm_request_segment, c'est-à-dire si l'instance en cours a été
+//    compilée avec une autre disposition du tampon. En cas d'échec, le
+//    programme s'arrête avec un message d'erreur.
+extern void attach_resources(void);
+
+//  load_config : relit SERVER_CONF_PATH s'il existe. Les valeurs absentes ou
+//    hors bornes conservent leur réglage courant.
+extern void load_config(void);
+
+//  open_lock : ouvre SERVER_LOCK_PATH et renvoie le PID du détenteur de son
+//    verrou, 0 s'il est libre. En cas d'échec, le programme s'arrête avec un
+//    message d'erreur.
+extern pid_t open_lock(void);
+
+//  take_over : prend le verrou LOCK_ACTIVE ou, s'il est détenu par une
+//    instance en cours, écarte l'instance qui attendait déjà la relève,
+//    prend le verrou LOCK_SUCCESSOR, envoie SIGUSR1 à l'instance active et
+//    diffère la prise du verrou LOCK_ACTIVE à check_predecessor. En cas
+//    d'échec, le programme s'arrête avec un message d'erreur.
+extern void take_over(void);
+
+//  check_predecessor : tente sans blocage de prendre le verrou LOCK_ACTIVE
+//    tant que l'instance relayée ne l'a pas libéré, puis libère
+//    LOCK_SUCCESSOR. Si une instance plus ancienne l'a obtenu entre-temps,
+//    celle-ci est relayée à son tour.
+extern void check_predecessor(void);
+
+//  drain_and_exit : cesse de consommer le tampon, laisse les ressources IPC à
+//    l'instance suivante, attend au plus DRAIN_TIMEOUT_S secondes la fin des
+//    Workers et de la file d'attente puis termine le processus. Les Workers
+//    restants sont alors tués ; les requêtes encore en attente, ou toutes
+//    celles-ci si le verrou n'a jamais été obtenu, sont rejetées par
+//    REPLY_BUSY.
+extern void drain_and_exit(void);
+
 //  daemonize : détache le serveur du terminal de contrôle, crée une nouvelle
 //    session (setsid) et redirige les entrées/sorties standards pour permettre
 //    une exécution permanente en arrière-plan.
 extern void daemonize(void);
 
-//  sigchld_handler : traite le signal SIGCHLD de manière asynchrone pour
-//    éliminer les processus "zombies" créés après la fin de l'exécution
-//    des processus Workers.
+//  sigchld_handler : capte le signal SIGCHLD afin d'interrompre l'attente sur
+//    le sémaphore ; les processus "zombies" sont ensuite éliminés par
+//    reap_workers dans la boucle principale. Capte aussi SIGALRM, qui borne
+//    l'attente de drain_and_exit.
 extern void sigchld_handler(int signum);
 
-//  main : point d'entrée du serveur. Configure les signaux, initialise les
-//    ressources, passe en mode démon et entre dans la boucle infinie de
-//    consommation des requêtes.
+//  control_signal_handler : note la réception de SIGHUP (rechargement de la
+//    configuration) ou de SIGUSR1 (relais vers une nouvelle instance) ; le
+//    traitement a lieu dans la boucle principale.
+extern void control_signal_handler(int signum);
+
+//  reap_workers : élimine sans blocage les Workers terminés et restitue au
+//    budget la mémoire qu'ils occupaient.
+extern void reap_workers(void);
+
+//  expire_workers : envoie SIGKILL aux Workers lancés depuis plus de
+//    WORKER_TIMEOUT_S secondes ; leur budget est restitué par reap_workers.
+extern void expire_workers(void);
+
+//  dispatch_pending : lance, dans l'ordre d'arrivée, les requêtes en attente
+//    tant que le budget le permet. Les requêtes dont le client a disparu
+//    pendant l'attente sont abandonnées sans lancer de Worker.
+extern void dispatch_pending(void);
+
+//  admit_request : refuse les filtres et transformations inconnus, estime
+//    l'empreinte mémoire de req, y compris le second segment d'une rotation
+//    d'un quart de tour, puis la lance, la met en attente ou la rejette en
+//    envoyant au client REPLY_INVALID, REPLY_TOO_LARGE ou REPLY_BUSY.
+extern void admit_request(struct filter_request req);
+
+//  main : point d'entrée du serveur. Configure les signaux, initialise ou
+//    reprend (--reprise) les ressources, passe en mode démon et entre dans la
+//    boucle de consommation des requêtes.
 int main(int argc, char *argv[]);
 
 #endif
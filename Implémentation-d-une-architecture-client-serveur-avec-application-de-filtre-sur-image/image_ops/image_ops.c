@@ -1,13 +1,116 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/ipc.h>
 #include <sys/shm.h>
+#include <sys/stat.h>
 
 #include "image_ops.h"
 
 //- CHARGEMENT ET MÉMOIRE --v---v---v---v---v---v---v---v---v---v---v---v---v---
 
+int parse_bmp_headers(const unsigned char *buf, size_t len,
+    BMPFileHeader *file_header, BMPInfoHeader *info_header,
+    size_t *pixel_data_size_out) {
+  if (len < BMP_HEADERS_SIZE) {
+    fprintf(stderr, "image_ops: En-têtes BMP tronqués.\n");
+    return -1;
+  }
+  memcpy(file_header, buf, sizeof(BMPFileHeader));
+  memcpy(info_header, buf + sizeof(BMPFileHeader), sizeof(BMPInfoHeader));
+  if (file_header->bfType != 0x4D42) {
+    fprintf(stderr, "image_ops: Format non BMP (0x4D42 attendu).\n");
+    return -1;
+  }
+  if (info_header->biSize < sizeof(BMPInfoHeader)
+      || info_header->biBitCount != 24 || info_header->biCompression != 0) {
+    fprintf(stderr, "image_ops: Seul le BMP 24 bits non compressé est "
+        "pris en charge.\n");
+    return -1;
+  }
+  if (info_header->biWidth <= 0 || info_header->biHeight == 0
+      || info_header->biHeight == INT32_MIN) {
+    fprintf(stderr, "image_ops: Dimensions invalides.\n");
+    return -1;
+  }
+  if ((uint64_t) file_header->bfOffBits
+      < sizeof(BMPFileHeader) + (uint64_t) info_header->biSize) {
+    fprintf(stderr, "image_ops: Décalage des pixels invalide.\n");
+    return -1;
+  }
+  size_t row_size = ((size_t) info_header->biWidth * 3 + 3) & ~(size_t) 3;
+  *pixel_data_size_out = row_size * (size_t) abs(info_header->biHeight);
+  return 0;
+}
+
+//  read_bmp_headers : lit les deux en-têtes BMP depuis f et les valide par
+//    parse_bmp_headers. Renvoie 0 en cas de succès, -1 sinon.
+static int read_bmp_headers(FILE *f, BMPFileHeader *file_header,
+    BMPInfoHeader *info_header, size_t *pixel_data_size_out) {
+  unsigned char buf[BMP_HEADERS_SIZE];
+  size_t len = fread(buf, 1, sizeof(buf), f);
+  return parse_bmp_headers(buf, len, file_header, info_header,
+      pixel_data_size_out);
+}
+
+int bmp_shm_footprint(const char *path, size_t *footprint_out,
+    size_t *rotated_footprint_out) {
+  int fd = open(path, O_RDONLY | O_NONBLOCK);
+  if (fd == -1) {
+    return -1;
+  }
+  struct stat st;
+  if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode)) {
+    fprintf(stderr, "image_ops: %s n'est pas un fichier ordinaire.\n", path);
+    close(fd);
+    return -1;
+  }
+  unsigned char buf[BMP_HEADERS_SIZE];
+  size_t len = 0;
+  while (len < sizeof(buf)) {
+    ssize_t n = read(fd, buf + len, sizeof(buf) - len);
+    if (n <= 0) {
+      break;
+    }
+    len += (size_t) n;
+  }
+  close(fd);
+  BMPFileHeader file_header;
+  BMPInfoHeader info_header;
+  size_t pixel_data_size;
+  if (parse_bmp_headers(buf, len, &file_header, &info_header,
+      &pixel_data_size) != 0) {
+    return -1;
+  }
+  size_t rotated_row_size = ((size_t) abs(info_header.biHeight) * 3 + 3)
+      & ~(size_t) 3;
+  *footprint_out = sizeof(struct image_data) + pixel_data_size;
+  *rotated_footprint_out = sizeof(struct image_data)
+      + rotated_row_size * (size_t) info_header.biWidth;
+  return 0;
+}
+
+//  alloc_image_shm : crée un segment SHM privé pouvant contenir une struct
+//    image_data suivie de pixel_data_size octets de pixels, initialisés à
+//    zéro. Renvoie l'adresse du segment attaché, nullptr en cas d'échec.
+static struct image_data *alloc_image_shm(size_t pixel_data_size) {
+  size_t full_size = sizeof(struct image_data) + pixel_data_size;
+  int shmid = shmget(IPC_PRIVATE, full_size, IPC_CREAT | 0666);
+  if (shmid < 0) {
+    return nullptr;
+  }
+  struct image_data *img_shm_ptr = (struct image_data *) shmat(shmid, nullptr,
+        0);
+  shmctl(shmid, IPC_RMID, nullptr);
+  if (img_shm_ptr == (void *) -1) {
+    return nullptr;
+  }
+  img_shm_ptr->data_size = (int) pixel_data_size;
+  return img_shm_ptr;
+}
+
 int load_bmp_image(const char *path, struct image_data **img_ptr,
     char **pixel_data_ptr, int *total_shm_size_out) {
   FILE *f = fopen(path, "rb");
@@ -17,39 +120,32 @@ int load_bmp_image(const char *path, struct image_data **img_ptr,
   }
   BMPFileHeader file_header;
   BMPInfoHeader info_header;
-  if (fread(&file_header, 1, sizeof(BMPFileHeader), f) != sizeof(BMPFileHeader)
-      || fread(&info_header, 1, sizeof(BMPInfoHeader),
-      f) != sizeof(BMPInfoHeader)) {
+  size_t pixel_data_size;
+  if (read_bmp_headers(f, &file_header, &info_header,
+      &pixel_data_size) != 0) {
     fclose(f);
     return -1;
   }
-  if (file_header.bfType != 0x4D42) {
-    fprintf(stderr, "image_ops: Format non BMP (0x4D42 attendu).\n");
+  if (pixel_data_size > MAX_IMAGE_SIZE) {
+    fprintf(stderr, "image_ops: Image trop volumineuse (%zu octets).\n",
+        pixel_data_size);
     fclose(f);
     return -1;
   }
-  int row_size = (int) ((info_header.biWidth * 3 + 3) & ~3);
-  unsigned int pixel_data_size = info_header.biSizeImage;
-  if (pixel_data_size == 0) {
-    pixel_data_size = (unsigned int) (row_size * abs(info_header.biHeight));
-  }
-  size_t full_size = sizeof(struct image_data) + (size_t) pixel_data_size;
-  *total_shm_size_out = (int) full_size;
-  int shmid = shmget(IPC_PRIVATE, full_size, IPC_CREAT | 0666);
-  if (shmid < 0) {
+  *total_shm_size_out = (int) (sizeof(struct image_data) + pixel_data_size);
+  struct image_data *img_shm_ptr = alloc_image_shm(pixel_data_size);
+  if (img_shm_ptr == nullptr) {
+    perror("image_ops: shm image");
     fclose(f);
-    return -1;
+    return LOAD_NO_MEMORY;
   }
-  struct image_data *img_shm_ptr = (struct image_data *) shmat(shmid, nullptr,
-        0);
-  shmctl(shmid, IPC_RMID, nullptr);
   img_shm_ptr->file_header = file_header;
   img_shm_ptr->info_header = info_header;
-  img_shm_ptr->data_size = (int) pixel_data_size;
   char *shm_pixel_data_base = (char *) img_shm_ptr + sizeof(struct image_data);
-  fseek(f, (long) file_header.bfOffBits, SEEK_SET);
   size_t sz_read = (size_t) pixel_data_size;
-  if (fread(shm_pixel_data_base, 1, sz_read, f) != sz_read) {
+  if (fseek(f, (long) file_header.bfOffBits, SEEK_SET) != 0
+      || fread(shm_pixel_data_base, 1, sz_read, f) != sz_read) {
+    fprintf(stderr, "image_ops: Données de pixels tronquées.\n");
     shmdt(img_shm_ptr);
     fclose(f);
     return -1;
@@ -60,16 +156,110 @@ int load_bmp_image(const char *path, struct image_data **img_ptr,
   return 0;
 }
 
+//- TRANSFORMATIONS GÉOMÉTRIQUES --v---v---v---v---v---v---v---v---v---v---v---
+
+//  transpose_pixels : écrit dans dst la transposée des pixels de src (width x
+//    height, lignes de stride src_stride). Si reverse_rows est non nul, la
+//    colonne x de src devient la ligne width - 1 - x de dst et la ligne r
+//    devient la colonne r ; sinon la colonne x devient la ligne x et la ligne
+//    r la colonne height - 1 - r. Le parcours par tuiles de TRANSPOSE_TILE
+//    pixels de côté maintient en cache les lignes source et destination
+//    touchées par une tuile, au lieu d'écrire une ligne destination
+//    différente à chaque pixel lu sur toute la largeur de l'image.
+static void transpose_pixels(const unsigned char *src, size_t src_stride,
+    int width, int height, unsigned char *dst, size_t dst_stride,
+    int reverse_rows) {
+  for (int r0 = 0; r0 < height; r0 += TRANSPOSE_TILE) {
+    int r1 = r0 + TRANSPOSE_TILE < height ? r0 + TRANSPOSE_TILE : height;
+    for (int x0 = 0; x0 < width; x0 += TRANSPOSE_TILE) {
+      int x1 = x0 + TRANSPOSE_TILE < width ? x0 + TRANSPOSE_TILE : width;
+      for (int r = r0; r < r1; r++) {
+        const unsigned char *s = src + (size_t) r * src_stride
+            + (size_t) x0 * 3;
+        size_t dst_col = (size_t) (reverse_rows ? r : height - 1 - r) * 3;
+        for (int x = x0; x < x1; x++, s += 3) {
+          int dst_row = reverse_rows ? width - 1 - x : x;
+          unsigned char *d = dst + (size_t) dst_row * dst_stride + dst_col;
+          d[0] = s[0];
+          d[1] = s[1];
+          d[2] = s[2];
+        }
+      }
+    }
+  }
+}
+
+int rotate_bmp_image(struct image_data *src_img, const char *src_pixels,
+    int clockwise, struct image_data **dst_img_ptr, char **dst_pixels_ptr,
+    int *total_shm_size_out) {
+  int width = src_img->info_header.biWidth;
+  int height = abs(src_img->info_header.biHeight);
+  int bottom_up = src_img->info_header.biHeight > 0;
+  size_t src_stride = ((size_t) width * 3 + 3) & ~(size_t) 3;
+  size_t dst_stride = ((size_t) height * 3 + 3) & ~(size_t) 3;
+  size_t pixel_data_size = dst_stride * (size_t) width;
+  struct image_data *dst_img = alloc_image_shm(pixel_data_size);
+  if (dst_img == nullptr) {
+    perror("image_ops: shm rotation");
+    return -1;
+  }
+  dst_img->file_header = src_img->file_header;
+  dst_img->info_header = src_img->info_header;
+  dst_img->info_header.biWidth = height;
+  dst_img->info_header.biHeight = bottom_up ? width : -width;
+  dst_img->info_header.biSizeImage = (uint32_t) pixel_data_size;
+  char *dst_pixels = (char *) dst_img + sizeof(struct image_data);
+  transpose_pixels((const unsigned char *) src_pixels, src_stride, width,
+      height, (unsigned char *) dst_pixels, dst_stride,
+      clockwise == bottom_up);
+  *dst_img_ptr = dst_img;
+  *dst_pixels_ptr = dst_pixels;
+  *total_shm_size_out = (int) (sizeof(struct image_data) + pixel_data_size);
+  return 0;
+}
+
+void flip_pixels(char *pixels, int width, int height, int horizontal,
+    int vertical) {
+  size_t stride = ((size_t) width * 3 + 3) & ~(size_t) 3;
+  unsigned char *base = (unsigned char *) pixels;
+  for (int y = 0; y < height; y++) {
+    int y2 = vertical ? height - 1 - y : y;
+    if (y2 < y) {
+      break;
+    }
+    unsigned char *a = base + (size_t) y * stride;
+    unsigned char *b = base + (size_t) y2 * stride;
+    if (horizontal) {
+      int count = (y == y2) ? width / 2 : width;
+      for (int x = 0; x < count; x++) {
+        unsigned char *pa = a + (size_t) x * 3;
+        unsigned char *pb = b + (size_t) (width - 1 - x) * 3;
+        for (int c = 0; c < 3; c++) {
+          unsigned char t = pa[c];
+          pa[c] = pb[c];
+          pb[c] = t;
+        }
+      }
+    } else if (y != y2) {
+      for (size_t i = 0; i < (size_t) width * 3; i++) {
+        unsigned char t = a[i];
+        a[i] = b[i];
+        b[i] = t;
+      }
+    }
+  }
+}
+
 //- FILTRES --v---v---v---v---v---v---v---v---v---v---v---v---v---v---v---v---v
 
 void apply_grayscale_filter(Pixel *pixels, int width, int height, int start_row,
-    int end_row) {
+    int end_row, int start_col, int end_col) {
   (void) height;
   int row_size_with_padding = (int) ((width * 3 + 3) & ~3);
   for (int y = start_row; y < end_row; y++) {
     unsigned char *row_ptr = ((unsigned char *) pixels)
         + ((long) y * row_size_with_padding);
-    for (int x = 0; x < width; x++) {
+    for (int x = start_col; x < end_col; x++) {
       Pixel *p = (Pixel *) (row_ptr + (x * 3));
       unsigned char gray = (unsigned char) (0.299 * (double) p->red
           + 0.587 * (double) p->green
@@ -80,12 +270,12 @@ void apply_grayscale_filter(Pixel *pixels, int width, int height, int start_row,
 }
 
 void apply_negative_filter(Pixel *pixels, int width, int start_row,
-    int end_row) {
+    int end_row, int start_col, int end_col) {
   int row_size_with_padding = ((width * 3 + 3) & ~3);
   for (int y = start_row; y < end_row; y++) {
     unsigned char *row_ptr = ((unsigned char *) pixels)
         + ((long) y * row_size_with_padding);
-    for (int x = 0; x < width; x++) {
+    for (int x = start_col; x < end_col; x++) {
       Pixel *p = (Pixel *) (row_ptr + (x * 3));
       p->red = (unsigned char) (255 - p->red);
       p->green = (unsigned char) (255 - p->green);
@@ -93,3 +283,21 @@ void apply_negative_filter(Pixel *pixels, int width, int start_row,
     }
   }
 }
+
+void apply_brightness_filter(Pixel *pixels, int width, int start_row,
+    int end_row, int start_col, int end_col, int adj) {
+  int row_size_with_padding = ((width * 3 + 3) & ~3);
+  for (int y = start_row; y < end_row; y++) {
+    unsigned char *row_ptr = ((unsigned char *) pixels)
+        + ((long) y * row_size_with_padding);
+    for (int x = start_col; x < end_col; x++) {
+      Pixel *p = (Pixel *) (row_ptr + (x * 3));
+      int r = (int) p->red + adj;
+      int g = (int) p->green + adj;
+      int b = (int) p->blue + adj;
+      p->red = (unsigned char) (r > 255 ? 255 : (r < 0 ? 0 : r));
+      p->green = (unsigned char) (g > 255 ? 255 : (g < 0 ? 0 : g));
+      p->blue = (unsigned char) (b > 255 ? 255 : (b < 0 ? 0 : b));
+    }
+  }
+}
@@ -6,8 +6,11 @@
 //  - il gère l'allocation de segments de mémoire partagée (SHM) privés ;
 //  - il implémente les calculs d'alignement (padding) pour garantir un accès
 //      mémoire correct aux pixels (alignement sur 4 octets) ;
+//  - il fournit les transformations géométriques (quart de tour par
+//      transposition par tuiles, miroirs et demi-tour sur place) ;
 //  - les algorithmes de filtrage sont conçus pour être "thread-safe" en ne
-//      travaillant que sur des plages de lignes (start_row à end_row).
+//      travaillant que sur des plages de lignes (start_row à end_row) ; la
+//      plage de colonnes permet de limiter le travail à une zone recadrée.
 
 #ifndef IMAGE_OPS__H
 #define IMAGE_OPS__H
@@ -16,24 +19,86 @@
 
 //- GESTION BINAIRE ET MÉMOIRE --v---v---v---v---v---v---v---v---v---v---v---v--
 
-//  load_bmp_image : ouvre le fichier au chemin path, vérifie la signature BMP
-//    et alloue un segment SHM de taille suffisante. Remplit les structures
-//    img_ptr (méta-données) et pixel_data_ptr (données brutes). Calcule la
-//    taille totale dans total_shm_size_out. Renvoie 0 en cas de succès.
+//  BMP_HEADERS_SIZE : taille cumulée des en-têtes lus avant les pixels.
+#define BMP_HEADERS_SIZE (sizeof(BMPFileHeader) + sizeof(BMPInfoHeader))
+
+//  LOAD_NO_MEMORY : échec de load_bmp_image dû à l'allocation du segment SHM
+//    et non au fichier ; la requête peut être retentée plus tard.
+#define LOAD_NO_MEMORY (-2)
+
+//  parse_bmp_headers : décode et valide les en-têtes BMP contenus dans les
+//    len premiers octets de buf, sans aucune entrée-sortie : signature,
+//    format 24 bits non compressé, dimensions et décalage des pixels. Affecte
+//    *file_header, *info_header et, dans *pixel_data_size_out, la taille des
+//    pixels déduite des dimensions (biSizeImage n'est pas utilisé). Convient
+//    comme point d'entrée d'un fuzzer. Renvoie 0 si les en-têtes sont
+//    valides, -1 sinon.
+extern int parse_bmp_headers(const unsigned char *buf, size_t len,
+    BMPFileHeader *file_header, BMPInfoHeader *info_header,
+    size_t *pixel_data_size_out);
+
+//  load_bmp_image : ouvre le fichier au chemin path, valide ses en-têtes par
+//    parse_bmp_headers et alloue un segment SHM de taille suffisante.
+//    Remplit les structures img_ptr (méta-données) et pixel_data_ptr
+//    (données brutes). Calcule la taille totale dans total_shm_size_out.
+//    Renvoie 0 en cas de succès, LOAD_NO_MEMORY si le segment n'a pu être
+//    alloué, -1 si le fichier est illisible ou invalide.
 extern int load_bmp_image(const char *path, struct image_data **img_ptr,
     char **pixel_data_ptr, int *total_shm_size_out);
 
+//  bmp_shm_footprint : lit uniquement les en-têtes du fichier BMP au chemin
+//    path et affecte à *footprint_out la taille du segment SHM que
+//    load_bmp_image allouerait pour cette image, et à *rotated_footprint_out
+//    celle du segment supplémentaire qu'allouerait rotate_bmp_image. Aucune
+//    donnée de pixel n'est lue. Le fichier est ouvert sans blocage et doit
+//    être un fichier ordinaire, afin qu'un tube nommé ne puisse suspendre
+//    l'appelant. Renvoie 0 en cas de succès, -1 si le fichier est illisible,
+//    n'est pas un fichier ordinaire ou n'est pas un BMP valide.
+extern int bmp_shm_footprint(const char *path, size_t *footprint_out,
+    size_t *rotated_footprint_out);
+
+//- TRANSFORMATIONS GÉOMÉTRIQUES --v---v---v---v---v---v---v---v---v---v---v---
+
+//  TRANSPOSE_TILE : côté, en pixels, des tuiles de la transposition. Une tuile
+//    de 64 x 64 pixels BGR touche 64 segments de ligne source et 64 segments
+//    de ligne destination de 192 octets (24 Ko), ce qui tient dans un cache
+//    L1 de données courant.
+#define TRANSPOSE_TILE 64
+
+//  rotate_bmp_image : alloue un nouveau segment SHM privé contenant l'image
+//    src_img (pixels src_pixels) tournée d'un quart de tour, dans le sens
+//    horaire si clockwise est non nul, anti-horaire sinon. Le sens de
+//    stockage des lignes (biHeight positif ou négatif) est conservé. Affecte
+//    *dst_img_ptr, *dst_pixels_ptr et *total_shm_size_out comme
+//    load_bmp_image. Le segment source n'est pas détaché. Renvoie 0 en cas de
+//    succès, -1 sinon.
+extern int rotate_bmp_image(struct image_data *src_img, const char *src_pixels,
+    int clockwise, struct image_data **dst_img_ptr, char **dst_pixels_ptr,
+    int *total_shm_size_out);
+
+//  flip_pixels : retourne sur place les pixels d'une image width x height,
+//    en miroir gauche-droite si horizontal est non nul et haut-bas si
+//    vertical est non nul. Les deux à la fois réalisent une rotation de 180°.
+extern void flip_pixels(char *pixels, int width, int height, int horizontal,
+    int vertical);
+
 //- ALGORITHMES DE FILTRAGE --v---v---v---v---v---v---v---v---v---v---v---v---v
 
 //  apply_grayscale_filter : transforme la zone de l'image définie par start_row
 //    et end_row en niveaux de gris en utilisant les coefficients de luminance
-//    standard (ITU-R BT.601).
+//    standard (ITU-R BT.601). Seules les colonnes de start_col à end_col
+//    (exclue) sont traitées.
 extern void apply_grayscale_filter(Pixel *pixels, int width, int height,
-    int start_row, int end_row);
+    int start_row, int end_row, int start_col, int end_col);
 
 //  apply_negative_filter : inverse les composantes colorimétriques (255 -
-//    valeur) sur la plage de lignes spécifiée.
+//    valeur) sur la plage de lignes et de colonnes spécifiée.
 extern void apply_negative_filter(Pixel *pixels, int width,
-    int start_row, int end_row);
+    int start_row, int end_row, int start_col, int end_col);
+
+//  apply_brightness_filter : ajoute adj à chaque composante, avec saturation
+//    dans [0, 255], sur la plage de lignes et de colonnes spécifiée.
+extern void apply_brightness_filter(Pixel *pixels, int width,
+    int start_row, int end_row, int start_col, int end_col, int adj);
 
 #endif
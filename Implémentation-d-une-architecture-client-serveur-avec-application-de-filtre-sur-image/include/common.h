@@ -5,6 +5,8 @@
 //  - La communication entre le client et le serveur repose sur un segment
 //      de mémoire partagée (SHM) et un sémaphore nommé pour la synchronisation.
 //  - Le transfert des images traitées s'effectue via des tubes nommés (FIFOs).
+//  - Chaque réponse débute par une struct filter_reply indiquant si l'image
+//      suit ou si la requête a été refusée (surcharge, image invalide).
 //  - Les structures BMP sont alignées rigoureusement sur 1 octet pour garantir
 //      la compatibilité avec le format de fichier binaire.
 
@@ -40,10 +42,22 @@
 
 //- PARAMÈTRES ET LIMITES --v---v---v---v---v---v---v---v---v---v---v---v---v--
 
+#define FILTER_NONE 0
 #define FILTER_GRAYSCALE 1
 #define FILTER_NEGATIVE 2
 #define FILTER_BRIGHTNESS 3
 
+//  Transformations géométriques appliquées par le Worker avant le filtre.
+//    GEOM_CROP lit le rectangle (x, y, largeur, hauteur) dans parametres[0..3],
+//    l'origine étant le coin supérieur gauche de l'image.
+#define GEOM_NONE 0
+#define GEOM_ROTATE_90 1
+#define GEOM_ROTATE_180 2
+#define GEOM_ROTATE_270 3
+#define GEOM_FLIP_H 4
+#define GEOM_FLIP_V 5
+#define GEOM_CROP 6
+
 //  MAX_IMAGE_SIZE : Limite de sécurité (100 Mo) pour éviter les débordements
 //    mémoire lors du chargement de fichiers BMP malformés.
 #define MAX_IMAGE_SIZE (100 * 1024 * 1024)
@@ -58,6 +72,7 @@ struct filter_request {
   pid_t pid;
   char chemin[256];
   int filtre;
+  int geometrie;
   int parametres[5];
 };
 
@@ -74,6 +89,21 @@ struct shm_request_segment {
   struct filter_request requests[MAX_REQUESTS];
 };
 
+//- STRUCTURES DE RÉPONSE --v---v---v---v---v---v---v---v---v---v---v---v---v-
+
+//  Statuts de réponse : REPLY_OK précède l'image traitée ; les autres valeurs
+//    signalent un refus ou un échec et ne sont suivies d'aucune donnée.
+#define REPLY_OK 0
+#define REPLY_BUSY 1
+#define REPLY_TOO_LARGE 2
+#define REPLY_INVALID 3
+
+//  struct filter_reply : Premier élément écrit dans la FIFO du client, que la
+//    requête ait été servie par un Worker ou rejetée par le serveur.
+struct filter_reply {
+  int32_t status;
+};
+
 //- FORMATS BINAIRES BMP (Alignement strict) --v---v---v---v---v---v---v---v---
 
 #pragma pack(push, 1) // Désactive le rembourrage d'octets (Padding)
@@ -122,13 +152,15 @@ struct image_data {
 
 //  struct thread_workspace : Contexte de travail envoyé à chaque thread POSIX.
 //    Permet la division du travail par bandes de lignes (parallélisme de
-//    données).
+//    données), restreintes aux colonnes utiles en cas de recadrage.
 struct thread_workspace {
   int thread_id;
   struct image_data *shm_img;
   Pixel *pixel_data_ptr;
   int ligne_debut;
   int ligne_fin;
+  int colonne_debut;
+  int colonne_fin;
   int filtre;
 };
 
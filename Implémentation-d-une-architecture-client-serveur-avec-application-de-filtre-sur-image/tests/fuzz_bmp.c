@@ -0,0 +1,134 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fuzz_bmp.h"
+#include "image_ops.h"
+
+//- CIBLE DU FUZZER --v---v---v---v---v---v---v---v---v---v---v---v---v---v---v
+
+//  invariant : interrompt le programme si cond est fausse.
+static void invariant(int cond, const char *what) {
+  if (!cond) {
+    printf("fuzz_bmp : invariant violé : %s\n", what);
+    fflush(stdout);
+    abort();
+  }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  BMPFileHeader file_header;
+  BMPInfoHeader info_header;
+  size_t pixel_data_size;
+  if (parse_bmp_headers(data, size, &file_header, &info_header,
+      &pixel_data_size) != 0) {
+    return 0;
+  }
+  invariant(size >= BMP_HEADERS_SIZE, "tampon tronqué accepté");
+  invariant(file_header.bfType == 0x4D42, "signature");
+  invariant(info_header.biBitCount == 24 && info_header.biCompression == 0,
+      "format de pixel");
+  invariant(info_header.biSize >= sizeof(BMPInfoHeader), "taille du DIB");
+  invariant(info_header.biWidth > 0, "largeur");
+  invariant(info_header.biHeight != 0 && info_header.biHeight != INT32_MIN,
+      "hauteur");
+  invariant((uint64_t) file_header.bfOffBits
+      >= sizeof(BMPFileHeader) + (uint64_t) info_header.biSize,
+      "décalage des pixels");
+  uint64_t stride = ((uint64_t) info_header.biWidth * 3 + 3) & ~(uint64_t) 3;
+  uint64_t height = (uint64_t) llabs((long long) info_header.biHeight);
+  invariant(pixel_data_size == stride * height, "taille des pixels");
+  return 0;
+}
+
+#ifndef FUZZ_WITH_LIBFUZZER
+
+//- REJEU ET MUTATIONS --v---v---v---v---v---v---v---v---v---v---v---v---v---v--
+
+unsigned int rng_state = 0x9E3779B9;
+
+//  next_random : renvoie la valeur suivante d'un générateur xorshift
+//    déterministe.
+static unsigned int next_random(void) {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state;
+}
+
+//  replay_file : soumet les FUZZ_MAX_INPUT premiers octets du fichier path.
+//    Renvoie 0 en cas de succès, -1 si le fichier est illisible.
+static int replay_file(const char *path) {
+  FILE *f = fopen(path, "rb");
+  if (f == nullptr) {
+    perror(path);
+    return -1;
+  }
+  uint8_t buf[FUZZ_MAX_INPUT];
+  size_t len = fread(buf, 1, sizeof(buf), f);
+  fclose(f);
+  LLVMFuzzerTestOneInput(buf, len);
+  return 0;
+}
+
+//  mutate : remplace dans buf, en-têtes valides d'une image aléatoire, des
+//    champs par des valeurs limites et des octets par des valeurs
+//    aléatoires. Renvoie la longueur du tampon à soumettre.
+static size_t mutate(uint8_t *buf) {
+  static const uint32_t limits[] = {
+    0, 1, 2, 3, 12, 14, 39, 40, 54, 0x7FFFFFFF, 0x80000000, 0xFFFFFFFF,
+    (uint32_t) MAX_IMAGE_SIZE,
+  };
+  BMPFileHeader file_header = {
+    .bfType = 0x4D42,
+    .bfOffBits = (uint32_t) BMP_HEADERS_SIZE,
+  };
+  BMPInfoHeader info_header = {
+    .biSize = sizeof(BMPInfoHeader),
+    .biWidth = (int32_t) (next_random() % 4096) + 1,
+    .biHeight = (int32_t) (next_random() % 4096) + 1,
+    .biPlanes = 1,
+    .biBitCount = 24,
+  };
+  if (next_random() % 2) {
+    info_header.biHeight = -info_header.biHeight;
+  }
+  memcpy(buf, &file_header, sizeof(file_header));
+  memcpy(buf + sizeof(file_header), &info_header, sizeof(info_header));
+  for (unsigned int n = next_random() % 4; n > 0; n--) {
+    uint32_t value = limits[next_random() % (sizeof(limits)
+        / sizeof(limits[0]))];
+    memcpy(buf + next_random() % (BMP_HEADERS_SIZE - 3), &value,
+        sizeof(value));
+  }
+  for (unsigned int n = next_random() % 4; n > 0; n--) {
+    buf[next_random() % BMP_HEADERS_SIZE] = (uint8_t) next_random();
+  }
+  for (size_t i = BMP_HEADERS_SIZE; i < FUZZ_MAX_INPUT; i++) {
+    buf[i] = (uint8_t) next_random();
+  }
+  return next_random() % 8 == 0 ? next_random() % FUZZ_MAX_INPUT
+      : BMP_HEADERS_SIZE + next_random() % (FUZZ_MAX_INPUT
+          - BMP_HEADERS_SIZE);
+}
+
+int main(int argc, char *argv[]) {
+  int replayed = 0;
+  for (int i = 1; i < argc; i++) {
+    if (replay_file(argv[i]) == 0) {
+      replayed++;
+    }
+  }
+  if (freopen("/dev/null", "w", stderr) == nullptr) {
+    perror("freopen");
+  }
+  uint8_t buf[FUZZ_MAX_INPUT];
+  for (int i = 0; i < FUZZ_ITERATIONS; i++) {
+    LLVMFuzzerTestOneInput(buf, mutate(buf));
+  }
+  printf("fuzz_bmp : %d fichiers rejoués, %d mutations, aucun invariant "
+      "violé.\n", replayed, FUZZ_ITERATIONS);
+  return EXIT_SUCCESS;
+}
+
+#endif
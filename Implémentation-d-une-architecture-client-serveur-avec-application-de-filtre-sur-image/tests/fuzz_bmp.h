@@ -0,0 +1,44 @@
+//  fuzz_bmp.h : partie interface du banc de fuzzing de parse_bmp_headers.
+//
+//  Fonctionnement général :
+//  - LLVMFuzzerTestOneInput soumet un tampon arbitraire à parse_bmp_headers
+//      et, si les en-têtes sont acceptés, vérifie les invariants dont
+//      dépendent load_bmp_image et bmp_shm_footprint ; une violation
+//      interrompt le programme par abort ;
+//  - compilé avec FUZZ_WITH_LIBFUZZER (cible « fuzz » du makefile, clang et
+//      -fsanitize=fuzzer), le point d'entrée est celui de libFuzzer ;
+//  - sinon, main rejoue les fichiers donnés en argument puis FUZZ_ITERATIONS
+//      mutations déterministes d'en-têtes valides, ce qui permet de l'exécuter
+//      dans la cible « test » avec n'importe quel compilateur.
+
+#ifndef FUZZ_BMP__H
+#define FUZZ_BMP__H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common.h"
+
+//- PARAMÈTRES --v---v---v---v---v---v---v---v---v---v---v---v---v---v---v---v-
+
+//  FUZZ_ITERATIONS : nombre de tampons mutés soumis par main.
+#define FUZZ_ITERATIONS 200000
+
+//  FUZZ_MAX_INPUT : taille maximale d'un tampon, en octets. Les fichiers
+//    rejoués sont tronqués à cette taille.
+#define FUZZ_MAX_INPUT 256
+
+//- PROCÉDURES DU MODULE --v---v---v---v---v---v---v---v---v---v---v---v---v---v
+
+//  LLVMFuzzerTestOneInput : soumet les size octets de data à
+//    parse_bmp_headers et vérifie les invariants des en-têtes acceptés.
+//    Renvoie toujours 0.
+extern int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+#ifndef FUZZ_WITH_LIBFUZZER
+//  main : rejoue chaque fichier de argv puis les mutations déterministes.
+//    Renvoie EXIT_SUCCESS si aucun invariant n'a été violé.
+int main(int argc, char *argv[]);
+#endif
+
+#endif
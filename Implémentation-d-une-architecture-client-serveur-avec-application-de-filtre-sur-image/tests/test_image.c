@@ -0,0 +1,738 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <dirent.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/shm.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "test_image.h"
+#include "image_ops.h"
+#include "worker.h"
+
+int failures = 0;
+int checks = 0;
+char corpus_dir[128] = { 0 };
+unsigned int rng_state = 0x2545F491;
+
+//  CHECK : compte une vérification et, si cond est fausse, affiche le message
+//    au format printf qui suit et compte un échec.
+#define CHECK(cond, ...)                                                       \
+  do {                                                                         \
+    checks++;                                                                  \
+    if (!(cond)) {                                                             \
+      failures++;                                                              \
+      printf("ÉCHEC %s:%d : ", __FILE__, __LINE__);                            \
+      printf(__VA_ARGS__);                                                     \
+      printf("\n");                                                            \
+    }                                                                          \
+  } while (0)
+
+//- GÉNÉRATION DU CORPUS --v---v---v---v---v---v---v---v---v---v---v---v---v---
+
+//  next_byte : renvoie l'octet suivant d'un générateur pseudo-aléatoire
+//    xorshift déterministe.
+static unsigned char next_byte(void) {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return (unsigned char) (rng_state >> 24);
+}
+
+//  image_new : alloue une image width x height noire, bourrage compris.
+static struct test_image image_new(int width, int height, int top_down) {
+  struct test_image img = {
+    .width = width,
+    .height = height,
+    .top_down = top_down,
+    .stride = ((size_t) width * 3 + 3) & ~(size_t) 3,
+  };
+  img.pixels = calloc(img.stride, (size_t) height);
+  if (img.pixels == nullptr) {
+    perror("calloc");
+    exit(EXIT_FAILURE);
+  }
+  return img;
+}
+
+//  pixel_at : renvoie l'adresse du pixel (x, y) de img, l'origine étant le
+//    coin supérieur gauche quel que soit le sens de stockage des lignes.
+static unsigned char *pixel_at(const struct test_image *img, int x, int y) {
+  int row = img->top_down ? y : img->height - 1 - y;
+  return img->pixels + (size_t) row * img->stride + (size_t) x * 3;
+}
+
+//  image_random : remplit les pixels de img, sans toucher au bourrage.
+static void image_random(struct test_image *img) {
+  for (int y = 0; y < img->height; y++) {
+    for (int x = 0; x < img->width; x++) {
+      unsigned char *p = pixel_at(img, x, y);
+      p[0] = next_byte();
+      p[1] = next_byte();
+      p[2] = next_byte();
+    }
+  }
+}
+
+//  make_headers : construit les en-têtes BMP de img tels que les écrit
+//    write_bmp et tels que worker_process doit les renvoyer.
+static void make_headers(const struct test_image *img,
+    BMPFileHeader *file_header, BMPInfoHeader *info_header) {
+  size_t pixel_data_size = img->stride * (size_t) img->height;
+  memset(file_header, 0, sizeof(*file_header));
+  memset(info_header, 0, sizeof(*info_header));
+  file_header->bfType = 0x4D42;
+  file_header->bfOffBits = (uint32_t) BMP_HEADERS_SIZE;
+  file_header->bfSize = (uint32_t) (BMP_HEADERS_SIZE + pixel_data_size);
+  info_header->biSize = sizeof(BMPInfoHeader);
+  info_header->biWidth = img->width;
+  info_header->biHeight = img->top_down ? -img->height : img->height;
+  info_header->biPlanes = 1;
+  info_header->biBitCount = 24;
+  info_header->biSizeImage = (uint32_t) pixel_data_size;
+}
+
+//  corpus_path : renvoie le chemin du fichier name du corpus. Le programme
+//    s'arrête si ce chemin excède le champ chemin d'une struct
+//    filter_request.
+static const char *corpus_path(const char *name) {
+  static char path[sizeof(((struct filter_request *) 0)->chemin)];
+  if (snprintf(path, sizeof(path), "%s/%s", corpus_dir, name)
+      >= (int) sizeof(path)) {
+    fprintf(stderr, "Chemin trop long : %s/%s\n", corpus_dir, name);
+    exit(EXIT_FAILURE);
+  }
+  return path;
+}
+
+//  write_raw : écrit dans le fichier name du corpus les en-têtes donnés,
+//    gap octets nuls puis pixel_len octets de pixels.
+static void write_raw(const char *name, const BMPFileHeader *file_header,
+    const BMPInfoHeader *info_header, size_t gap, const unsigned char *pixels,
+    size_t pixel_len) {
+  const char *path = corpus_path(name);
+  FILE *f = fopen(path, "wb");
+  if (f == nullptr) {
+    perror(path);
+    exit(EXIT_FAILURE);
+  }
+  fwrite(file_header, sizeof(*file_header), 1, f);
+  fwrite(info_header, sizeof(*info_header), 1, f);
+  for (size_t i = 0; i < gap; i++) {
+    fputc(0, f);
+  }
+  if (pixel_len > 0) {
+    fwrite(pixels, 1, pixel_len, f);
+  }
+  fclose(f);
+}
+
+//  write_bmp : écrit img dans le fichier name du corpus.
+static void write_bmp(const char *name, const struct test_image *img) {
+  BMPFileHeader file_header;
+  BMPInfoHeader info_header;
+  make_headers(img, &file_header, &info_header);
+  write_raw(name, &file_header, &info_header, 0, img->pixels,
+      img->stride * (size_t) img->height);
+}
+
+//- RÉFÉRENCES SCALAIRES --v---v---v---v---v---v---v---v---v---v---v---v---v---
+
+//  ref_pixel : applique filtre au pixel BGR p, un pixel à la fois. adj est
+//    l'ajustement du filtre FILTER_BRIGHTNESS.
+static void ref_pixel(unsigned char *p, int filtre, int adj) {
+  switch (filtre) {
+    case FILTER_GRAYSCALE:
+      {
+        unsigned char gray = (unsigned char) (0.299 * (double) p[2]
+            + 0.587 * (double) p[1] + 0.114 * (double) p[0]);
+        p[0] = p[1] = p[2] = gray;
+        break;
+      }
+    case FILTER_NEGATIVE:
+      for (int c = 0; c < 3; c++) {
+        p[c] = (unsigned char) (255 - p[c]);
+      }
+      break;
+    case FILTER_BRIGHTNESS:
+      for (int c = 0; c < 3; c++) {
+        int v = p[c] + adj;
+        p[c] = (unsigned char) (v > 255 ? 255 : (v < 0 ? 0 : v));
+      }
+      break;
+  }
+}
+
+//  ref_transform : renvoie une nouvelle image, de même sens de stockage que
+//    src, résultant de la transformation geometrie (rectangle rect pour
+//    GEOM_CROP) puis du filtre filtre, calculée pixel par pixel.
+static struct test_image ref_transform(const struct test_image *src,
+    int geometrie, const int rect[4], int filtre) {
+  int w = src->width;
+  int h = src->height;
+  int out_w = w;
+  int out_h = h;
+  if (geometrie == GEOM_ROTATE_90 || geometrie == GEOM_ROTATE_270) {
+    out_w = h;
+    out_h = w;
+  } else if (geometrie == GEOM_CROP) {
+    out_w = rect[2];
+    out_h = rect[3];
+  }
+  struct test_image dst = image_new(out_w, out_h, src->top_down);
+  for (int y = 0; y < out_h; y++) {
+    for (int x = 0; x < out_w; x++) {
+      int sx = x;
+      int sy = y;
+      switch (geometrie) {
+        case GEOM_ROTATE_90:
+          sx = y;
+          sy = h - 1 - x;
+          break;
+        case GEOM_ROTATE_270:
+          sx = w - 1 - y;
+          sy = x;
+          break;
+        case GEOM_ROTATE_180:
+          sx = w - 1 - x;
+          sy = h - 1 - y;
+          break;
+        case GEOM_FLIP_H:
+          sx = w - 1 - x;
+          break;
+        case GEOM_FLIP_V:
+          sy = h - 1 - y;
+          break;
+        case GEOM_CROP:
+          sx = rect[0] + x;
+          sy = rect[1] + y;
+          break;
+      }
+      unsigned char *p = pixel_at(&dst, x, y);
+      memcpy(p, pixel_at(src, sx, sy), 3);
+      ref_pixel(p, filtre, BRIGHTNESS_ADJUSTMENT);
+    }
+  }
+  return dst;
+}
+
+//- CHARGEMENT ET EN-TÊTES --v---v---v---v---v---v---v---v---v---v---v---v---v--
+
+//  check_load : vérifie que le fichier name est chargé à l'identique de img
+//    et que bmp_shm_footprint annonce les tailles de segment attendues.
+static void check_load(const char *name, const struct test_image *img) {
+  struct image_data *shm_img;
+  char *pixels;
+  int total;
+  size_t pixel_data_size = img->stride * (size_t) img->height;
+  if (load_bmp_image(corpus_path(name), &shm_img, &pixels, &total) != 0) {
+    CHECK(0, "%s : chargement refusé", name);
+    return;
+  }
+  CHECK(shm_img->info_header.biWidth == img->width
+      && abs(shm_img->info_header.biHeight) == img->height
+      && (shm_img->info_header.biHeight < 0) == img->top_down,
+      "%s : dimensions lues incorrectes", name);
+  CHECK((size_t) shm_img->data_size == pixel_data_size
+      && (size_t) total == sizeof(struct image_data) + pixel_data_size,
+      "%s : taille de segment incorrecte", name);
+  CHECK(memcmp(pixels, img->pixels, pixel_data_size) == 0,
+      "%s : pixels chargés différents du fichier", name);
+  shmdt(shm_img);
+  size_t footprint;
+  size_t rotated_footprint;
+  size_t rotated_stride = ((size_t) img->height * 3 + 3) & ~(size_t) 3;
+  CHECK(bmp_shm_footprint(corpus_path(name), &footprint,
+        &rotated_footprint) == 0
+      && footprint == sizeof(struct image_data) + pixel_data_size
+      && rotated_footprint == sizeof(struct image_data)
+          + rotated_stride * (size_t) img->width,
+      "%s : empreinte mémoire incorrecte", name);
+}
+
+//  check_admission_refused : vérifie que bmp_shm_footprint refuse le fichier
+//    name dès la lecture de ses en-têtes.
+static void check_admission_refused(const char *name) {
+  size_t footprint;
+  size_t rotated_footprint;
+  CHECK(bmp_shm_footprint(corpus_path(name), &footprint,
+        &rotated_footprint) != 0,
+      "%s : en-têtes invalides acceptés à l'admission", name);
+}
+
+//  check_rejected : vérifie que le fichier name est refusé au chargement et,
+//    si headers_invalid est non nul, dès l'admission.
+static void check_rejected(const char *name, int headers_invalid) {
+  struct image_data *shm_img;
+  char *pixels;
+  int total;
+  CHECK(load_bmp_image(corpus_path(name), &shm_img, &pixels, &total) != 0,
+      "%s : fichier invalide accepté", name);
+  if (headers_invalid) {
+    check_admission_refused(name);
+  }
+}
+
+//  test_invalid_files : génère des fichiers tronqués ou aux en-têtes
+//    invalides et vérifie qu'ils sont tous refusés.
+static void test_invalid_files(void) {
+  struct test_image img = image_new(5, 7, 0);
+  image_random(&img);
+  size_t pixel_data_size = img.stride * (size_t) img.height;
+  BMPFileHeader fh;
+  BMPInfoHeader ih;
+  make_headers(&img, &fh, &ih);
+  write_raw("tronque_entetes.bmp", &fh, &ih, 0, nullptr, 0);
+  if (truncate(corpus_path("tronque_entetes.bmp"), 30) != 0) {
+    perror("truncate");
+  }
+  check_rejected("tronque_entetes.bmp", 1);
+  write_raw("tronque_pixels.bmp", &fh, &ih, 0, img.pixels,
+      pixel_data_size - 1);
+  check_rejected("tronque_pixels.bmp", 0);
+  write_raw("entetes_seuls.bmp", &fh, &ih, 0, nullptr, 0);
+  check_rejected("entetes_seuls.bmp", 0);
+  BMPFileHeader bad_fh = fh;
+  BMPInfoHeader bad_ih = ih;
+  bad_fh.bfOffBits = 1000;
+  write_raw("decalage_hors_fichier.bmp", &bad_fh, &ih, 0, img.pixels,
+      pixel_data_size);
+  check_rejected("decalage_hors_fichier.bmp", 0);
+  bad_fh = fh;
+  bad_fh.bfOffBits = 20;
+  write_raw("decalage_court.bmp", &bad_fh, &ih, 0, img.pixels,
+      pixel_data_size);
+  check_rejected("decalage_court.bmp", 1);
+  bad_fh = fh;
+  bad_fh.bfType = 0x5858;
+  write_raw("signature.bmp", &bad_fh, &ih, 0, img.pixels, pixel_data_size);
+  check_rejected("signature.bmp", 1);
+  bad_ih = ih;
+  bad_ih.biBitCount = 32;
+  write_raw("bpp32.bmp", &fh, &bad_ih, 0, img.pixels, pixel_data_size);
+  check_rejected("bpp32.bmp", 1);
+  bad_ih = ih;
+  bad_ih.biCompression = 1;
+  write_raw("compresse.bmp", &fh, &bad_ih, 0, img.pixels, pixel_data_size);
+  check_rejected("compresse.bmp", 1);
+  bad_ih = ih;
+  bad_ih.biSize = 12;
+  write_raw("dib_court.bmp", &fh, &bad_ih, 0, img.pixels, pixel_data_size);
+  check_rejected("dib_court.bmp", 1);
+  bad_ih = ih;
+  bad_ih.biWidth = 0;
+  write_raw("largeur_nulle.bmp", &fh, &bad_ih, 0, img.pixels,
+      pixel_data_size);
+  check_rejected("largeur_nulle.bmp", 1);
+  bad_ih = ih;
+  bad_ih.biWidth = -5;
+  write_raw("largeur_negative.bmp", &fh, &bad_ih, 0, img.pixels,
+      pixel_data_size);
+  check_rejected("largeur_negative.bmp", 1);
+  bad_ih = ih;
+  bad_ih.biHeight = 0;
+  write_raw("hauteur_nulle.bmp", &fh, &bad_ih, 0, img.pixels,
+      pixel_data_size);
+  check_rejected("hauteur_nulle.bmp", 1);
+  bad_ih = ih;
+  bad_ih.biHeight = INT32_MIN;
+  write_raw("hauteur_min.bmp", &fh, &bad_ih, 0, img.pixels,
+      pixel_data_size);
+  check_rejected("hauteur_min.bmp", 1);
+  check_rejected("absent.bmp", 1);
+  BMPFileHeader gap_fh = fh;
+  gap_fh.bfOffBits += 16;
+  write_raw("decalage_long.bmp", &gap_fh, &ih, 16, img.pixels,
+      pixel_data_size);
+  check_load("decalage_long.bmp", &img);
+  if (mkfifo(corpus_path("tube.bmp"), 0600) == 0) {
+    check_admission_refused("tube.bmp");
+    unlink(corpus_path("tube.bmp"));
+  }
+  unsigned char buf[BMP_HEADERS_SIZE];
+  memcpy(buf, &fh, sizeof(fh));
+  memcpy(buf + sizeof(fh), &ih, sizeof(ih));
+  size_t pixel_size;
+  CHECK(parse_bmp_headers(buf, sizeof(buf), &bad_fh, &bad_ih,
+        &pixel_size) == 0 && pixel_size == pixel_data_size,
+      "parse_bmp_headers : en-têtes valides refusés");
+  CHECK(parse_bmp_headers(buf, sizeof(buf) - 1, &bad_fh, &bad_ih,
+        &pixel_size) != 0,
+      "parse_bmp_headers : tampon tronqué accepté");
+  free(img.pixels);
+}
+
+//  test_size_limit : vérifie qu'une image occupant exactement MAX_IMAGE_SIZE
+//    octets de pixels est acceptée et qu'une ligne de plus la fait refuser.
+//    Les fichiers sont creux et supprimés après usage.
+static void test_size_limit(void) {
+  struct test_image img = { .width = 1365, .top_down = 0 };
+  img.stride = ((size_t) img.width * 3 + 3) & ~(size_t) 3;
+  img.height = (int) (MAX_IMAGE_SIZE / img.stride);
+  CHECK(img.stride * (size_t) img.height == MAX_IMAGE_SIZE,
+      "limite : largeur %d ne divise pas MAX_IMAGE_SIZE", img.width);
+  for (int extra = 0; extra <= 1; extra++) {
+    struct test_image limit = img;
+    limit.height += extra;
+    size_t pixel_data_size = limit.stride * (size_t) limit.height;
+    BMPFileHeader fh;
+    BMPInfoHeader ih;
+    make_headers(&limit, &fh, &ih);
+    const char *name = extra ? "limite_depassee.bmp" : "limite.bmp";
+    write_raw(name, &fh, &ih, 0, nullptr, 0);
+    if (truncate(corpus_path(name),
+          (off_t) (BMP_HEADERS_SIZE + pixel_data_size)) != 0) {
+      perror("truncate");
+    }
+    struct image_data *shm_img;
+    char *pixels;
+    int total;
+    int loaded = load_bmp_image(corpus_path(name), &shm_img, &pixels,
+        &total) == 0;
+    CHECK(loaded == !extra, "%s : hauteur %d %s", name, limit.height,
+        extra ? "acceptée" : "refusée");
+    if (loaded) {
+      CHECK((size_t) shm_img->data_size == pixel_data_size,
+          "%s : taille de segment incorrecte", name);
+      shmdt(shm_img);
+    }
+    size_t footprint;
+    size_t rotated_footprint;
+    CHECK(bmp_shm_footprint(corpus_path(name), &footprint,
+          &rotated_footprint) == 0
+        && (footprint > sizeof(struct image_data) + (size_t) MAX_IMAGE_SIZE)
+            == extra,
+        "%s : empreinte incohérente avec MAX_IMAGE_SIZE", name);
+    unlink(corpus_path(name));
+  }
+}
+
+//- FILTRES --v---v---v---v---v---v---v---v---v---v---v---v---v---v---v---v---v
+
+//  check_filter : applique filtre aux lignes [sr, er) et colonnes [sc, ec)
+//    d'une copie de img et compare toute l'image, bourrage compris, à la
+//    référence scalaire.
+static void check_filter(const struct test_image *img, int filtre, int adj,
+    int sr, int er, int sc, int ec) {
+  size_t size = img->stride * (size_t) img->height;
+  unsigned char *got = malloc(size);
+  unsigned char *expected = malloc(size);
+  if (got == nullptr || expected == nullptr) {
+    perror("malloc");
+    exit(EXIT_FAILURE);
+  }
+  memcpy(got, img->pixels, size);
+  memcpy(expected, img->pixels, size);
+  switch (filtre) {
+    case FILTER_GRAYSCALE:
+      apply_grayscale_filter((Pixel *) got, img->width, img->height, sr, er,
+          sc, ec);
+      break;
+    case FILTER_NEGATIVE:
+      apply_negative_filter((Pixel *) got, img->width, sr, er, sc, ec);
+      break;
+    case FILTER_BRIGHTNESS:
+      apply_brightness_filter((Pixel *) got, img->width, sr, er, sc, ec, adj);
+      break;
+  }
+  for (int y = sr; y < er; y++) {
+    for (int x = sc; x < ec; x++) {
+      ref_pixel(expected + (size_t) y * img->stride + (size_t) x * 3, filtre,
+          adj);
+    }
+  }
+  CHECK(memcmp(got, expected, size) == 0,
+      "filtre %d (adj %d) %dx%d lignes [%d,%d) colonnes [%d,%d)", filtre, adj,
+      img->width, img->height, sr, er, sc, ec);
+  free(got);
+  free(expected);
+}
+
+//  test_filters : compare les trois filtres à leur référence sur plusieurs
+//    zones de img : image entière, zone intérieure, premier pixel et zone
+//    vide.
+static void test_filters(const struct test_image *img) {
+  int w = img->width;
+  int h = img->height;
+  int zones[][4] = {
+    { 0, h, 0, w },
+    { h / 3, h, w / 2, w },
+    { 0, 1, 0, 1 },
+    { h / 2, h / 2, 0, w },
+  };
+  for (size_t z = 0; z < sizeof(zones) / sizeof(zones[0]); z++) {
+    int *zone = zones[z];
+    check_filter(img, FILTER_GRAYSCALE, 0, zone[0], zone[1], zone[2],
+        zone[3]);
+    check_filter(img, FILTER_NEGATIVE, 0, zone[0], zone[1], zone[2],
+        zone[3]);
+    check_filter(img, FILTER_BRIGHTNESS, BRIGHTNESS_ADJUSTMENT, zone[0],
+        zone[1], zone[2], zone[3]);
+    check_filter(img, FILTER_BRIGHTNESS, -80, zone[0], zone[1], zone[2],
+        zone[3]);
+  }
+}
+
+//- WORKER --v---v---v---v---v---v---v---v---v---v---v---v---v---v---v---v---v--
+
+//  run_worker : exécute worker_process dans un processus fils pour le
+//    fichier name du corpus et lit sa réponse sur la FIFO du processus
+//    courant. Affecte à *data et *len le flux reçu après la struct
+//    filter_reply (à libérer par free). Renvoie le statut reçu, -1 si aucune
+//    réponse n'est arrivée.
+static int run_worker(const char *name, int filtre, int geometrie,
+    const int rect[4], int num_threads, unsigned char **data, size_t *len) {
+  char fifo_path[256];
+  snprintf(fifo_path, sizeof(fifo_path), "%s%d", FIFO_REP_PATH, getpid());
+  if (mkfifo(fifo_path, 0600) < 0 && errno != EEXIST) {
+    perror("mkfifo");
+    exit(EXIT_FAILURE);
+  }
+  int fd_fifo = open(fifo_path, O_RDONLY | O_NONBLOCK);
+  if (fd_fifo == -1) {
+    perror("open FIFO");
+    exit(EXIT_FAILURE);
+  }
+  struct filter_request req = {
+    .pid = getpid(),
+    .filtre = filtre,
+    .geometrie = geometrie,
+  };
+  memcpy(req.chemin, corpus_path(name), sizeof(req.chemin));
+  memcpy(req.parametres, rect, 4 * sizeof(int));
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid < 0) {
+    perror("fork");
+    exit(EXIT_FAILURE);
+  }
+  if (pid == 0) {
+    close(fd_fifo);
+    worker_process(req, num_threads);
+    _exit(EXIT_SUCCESS);
+  }
+  int status = -1;
+  *data = nullptr;
+  *len = 0;
+  struct pollfd pfd = { .fd = fd_fifo, .events = POLLIN };
+  if (poll(&pfd, 1, TEST_REPLY_TIMEOUT_MS) > 0) {
+    int flags = fcntl(fd_fifo, F_GETFL, 0);
+    fcntl(fd_fifo, F_SETFL, flags & ~O_NONBLOCK);
+    struct filter_reply reply;
+    if (read(fd_fifo, &reply, sizeof(reply)) == (ssize_t) sizeof(reply)) {
+      status = reply.status;
+      size_t capacity = 0;
+      ssize_t n;
+      do {
+        if (*len == capacity) {
+          capacity = capacity == 0 ? 4096 : 2 * capacity;
+          unsigned char *grown = realloc(*data, capacity);
+          if (grown == nullptr) {
+            perror("realloc");
+            exit(EXIT_FAILURE);
+          }
+          *data = grown;
+        }
+        n = read(fd_fifo, *data + *len, capacity - *len);
+        if (n > 0) {
+          *len += (size_t) n;
+        }
+      } while (n > 0);
+    }
+  }
+  close(fd_fifo);
+  waitpid(pid, nullptr, 0);
+  unlink(fifo_path);
+  return status;
+}
+
+//  check_worker : compare, en-têtes et bourrage compris, la réponse de
+//    worker_process pour le fichier name (image img) à l'image de référence.
+static void check_worker(const char *name, const struct test_image *img,
+    int filtre, int geometrie, const int rect[4], int num_threads) {
+  unsigned char *data;
+  size_t len;
+  int status = run_worker(name, filtre, geometrie, rect, num_threads, &data,
+      &len);
+  struct test_image expected = ref_transform(img, geometrie, rect, filtre);
+  BMPFileHeader fh;
+  BMPInfoHeader ih;
+  make_headers(&expected, &fh, &ih);
+  size_t pixel_data_size = expected.stride * (size_t) expected.height;
+  CHECK(status == REPLY_OK
+      && len == BMP_HEADERS_SIZE + pixel_data_size
+      && memcmp(data, &fh, sizeof(fh)) == 0
+      && memcmp(data + sizeof(fh), &ih, sizeof(ih)) == 0
+      && memcmp(data + BMP_HEADERS_SIZE, expected.pixels,
+          pixel_data_size) == 0,
+      "%s : géométrie %d (%d,%d,%d,%d) filtre %d, %d threads : statut %d, "
+      "%zu octets reçus", name, geometrie, rect[0], rect[1], rect[2], rect[3],
+      filtre, num_threads, status, len);
+  free(data);
+  free(expected.pixels);
+}
+
+//  check_worker_refused : vérifie que worker_process répond expected_status
+//    sans données d'image.
+static void check_worker_refused(const char *name, int filtre, int geometrie,
+    const int rect[4], int expected_status) {
+  unsigned char *data;
+  size_t len;
+  int status = run_worker(name, filtre, geometrie, rect, 2, &data, &len);
+  CHECK(status == expected_status && len == 0,
+      "%s : filtre %d géométrie %d (%d,%d,%d,%d) : statut %d et %zu octets, "
+      "statut %d attendu", name, filtre, geometrie, rect[0], rect[1], rect[2],
+      rect[3], status, len, expected_status);
+  free(data);
+}
+
+//  check_worker_client_gone : vérifie que worker_process se termine sans
+//    bloquer lorsque la FIFO du client existe mais que personne ne la lit,
+//    comme après l'arrêt brutal d'un client ayant déposé sa requête.
+static void check_worker_client_gone(const char *name) {
+  char fifo_path[256];
+  snprintf(fifo_path, sizeof(fifo_path), "%s%d", FIFO_REP_PATH, getpid());
+  if (mkfifo(fifo_path, 0600) < 0 && errno != EEXIST) {
+    perror("mkfifo");
+    exit(EXIT_FAILURE);
+  }
+  struct filter_request req = {
+    .pid = getpid(),
+    .filtre = FILTER_NEGATIVE,
+    .geometrie = GEOM_NONE,
+  };
+  memcpy(req.chemin, corpus_path(name), sizeof(req.chemin));
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid < 0) {
+    perror("fork");
+    exit(EXIT_FAILURE);
+  }
+  if (pid == 0) {
+    worker_process(req, 2);
+    _exit(EXIT_SUCCESS);
+  }
+  pid_t done;
+  int waited_ms = 0;
+  while ((done = waitpid(pid, nullptr, WNOHANG)) == 0
+      && waited_ms < TEST_REPLY_TIMEOUT_MS) {
+    poll(nullptr, 0, 10);
+    waited_ms += 10;
+  }
+  if (done == 0) {
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+  }
+  CHECK(done == pid, "%s : Worker bloqué sur la FIFO d'un client disparu",
+      name);
+  unlink(fifo_path);
+}
+
+//  test_worker : compare la sortie de worker_process à la référence pour
+//    toutes les transformations et tous les filtres, dont quatre
+//    recadrages : image entière, zone intérieure, dernière colonne et toutes
+//    les colonnes sauf la première. Vérifie ensuite les refus et l'abandon
+//    d'une requête dont le client a disparu.
+static void test_worker(const char *name, const struct test_image *img) {
+  int w = img->width;
+  int h = img->height;
+  int full[4] = { 0, 0, w, h };
+  int crops[][4] = {
+    { 0, 0, w, h },
+    { w / 3, h / 4, w - w / 3 > 1 ? w - w / 3 - 1 : 1,
+      h - h / 4 > 1 ? h - h / 4 - 1 : 1 },
+    { w - 1, 0, 1, h },
+    { w > 1 ? 1 : 0, 0, w > 1 ? w - 1 : 1, h },
+  };
+  static int runs = 0;
+  for (int filtre = FILTER_NONE; filtre <= FILTER_BRIGHTNESS; filtre++) {
+    for (int geometrie = GEOM_NONE; geometrie < GEOM_CROP; geometrie++) {
+      check_worker(name, img, filtre, geometrie, full,
+          1 + runs++ % TEST_THREADS_MAX);
+    }
+    for (size_t c = 0; c < sizeof(crops) / sizeof(crops[0]); c++) {
+      check_worker(name, img, filtre, GEOM_CROP, crops[c],
+          1 + runs++ % TEST_THREADS_MAX);
+    }
+  }
+  int outside[4] = { w - 1, 0, 2, h };
+  int empty[4] = { 0, 0, 0, h };
+  check_worker_refused(name, FILTER_NEGATIVE, GEOM_CROP, outside,
+      REPLY_INVALID);
+  check_worker_refused(name, FILTER_NEGATIVE, GEOM_CROP, empty,
+      REPLY_INVALID);
+  check_worker_refused(name, FILTER_NEGATIVE, GEOM_CROP + 1, full,
+      REPLY_INVALID);
+  check_worker_refused(name, FILTER_NEGATIVE, -1, full, REPLY_INVALID);
+  check_worker_refused(name, FILTER_BRIGHTNESS + 1, GEOM_NONE, full,
+      REPLY_INVALID);
+  check_worker_refused(name, -1, GEOM_ROTATE_90, full, REPLY_INVALID);
+  check_worker_client_gone(name);
+}
+
+//- POINT D'ENTRÉE --v---v---v---v---v---v---v---v---v---v---v---v---v---v---v--
+
+//  remove_corpus : supprime le répertoire temporaire du corpus et son
+//    contenu.
+static void remove_corpus(void) {
+  DIR *dir = opendir(corpus_dir);
+  if (dir == nullptr) {
+    return;
+  }
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != nullptr) {
+    if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+      unlink(corpus_path(entry->d_name));
+    }
+  }
+  closedir(dir);
+  rmdir(corpus_dir);
+}
+
+int main(int argc, char *argv[]) {
+  if (argc > 2) {
+    fprintf(stderr, "Usage: %s [répertoire_corpus]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (argc == 2) {
+    snprintf(corpus_dir, sizeof(corpus_dir), "%s", argv[1]);
+    if (mkdir(corpus_dir, 0755) != 0 && errno != EEXIST) {
+      perror(corpus_dir);
+      return EXIT_FAILURE;
+    }
+  } else {
+    snprintf(corpus_dir, sizeof(corpus_dir), "/tmp/test_image_XXXXXX");
+    if (mkdtemp(corpus_dir) == nullptr) {
+      perror("mkdtemp");
+      return EXIT_FAILURE;
+    }
+    atexit(remove_corpus);
+  }
+  const int sizes[][2] = {
+    { 1, 1 }, { 2, 3 }, { 3, 2 }, { 5, 7 }, { 8, 3 }, { 13, 1 }, { 1, 13 },
+    { 67, 65 },
+  };
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    for (int top_down = 0; top_down <= 1; top_down++) {
+      struct test_image img = image_new(sizes[s][0], sizes[s][1], top_down);
+      image_random(&img);
+      char name[64];
+      snprintf(name, sizeof(name), "image_%dx%d_%s.bmp", img.width,
+          img.height, top_down ? "haut_bas" : "bas_haut");
+      write_bmp(name, &img);
+      check_load(name, &img);
+      test_filters(&img);
+      test_worker(name, &img);
+      free(img.pixels);
+    }
+  }
+  test_invalid_files();
+  test_size_limit();
+  printf("test_image : %d vérifications, %d échecs.\n", checks, failures);
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,58 @@
+//  test_image.h : partie interface du programme de test des modules
+//    image_ops et worker (cible « test » du makefile).
+//
+//  Fonctionnement général :
+//  - le programme génère un corpus de fichiers BMP 24 bits : largeurs
+//      impaires (lignes avec bourrage), images stockées de bas en haut et de
+//      haut en bas, image 1 x 1, image à la limite exacte MAX_IMAGE_SIZE et
+//      fichiers tronqués ou aux en-têtes invalides ;
+//  - chaque fichier valide est rechargé par load_bmp_image et comparé octet
+//      par octet au fichier généré ; chaque fichier invalide doit être
+//      rejeté ;
+//  - les filtres sont comparés, sur des plages de lignes et de colonnes
+//      variées, à une implémentation de référence scalaire pixel par pixel ;
+//  - worker_process est exécuté dans un processus fils pour chaque
+//      combinaison de transformation géométrique (rotations, miroirs,
+//      recadrage) et de filtre : le flux reçu sur la FIFO est comparé, bourrage
+//      compris, à une image de référence calculée indépendamment ; un
+//      Worker dont le client a disparu sans lire sa FIFO doit se terminer ;
+//  - le programme affiche chaque échec et se termine par EXIT_FAILURE si au
+//      moins une vérification a échoué.
+
+#ifndef TEST_IMAGE__H
+#define TEST_IMAGE__H
+
+#include "common.h"
+
+//- PARAMÈTRES --v---v---v---v---v---v---v---v---v---v---v---v---v---v---v---v-
+
+//  TEST_THREADS_MAX : nombre maximal de threads confiés à worker_process. Les
+//    exécutions successives utilisent de 1 à TEST_THREADS_MAX threads afin
+//    que certaines bandes soient vides.
+#define TEST_THREADS_MAX 5
+
+//  TEST_REPLY_TIMEOUT_MS : délai d'attente maximal de la réponse ou de la
+//    fin d'un Worker de test.
+#define TEST_REPLY_TIMEOUT_MS 5000
+
+//  struct test_image : image BMP 24 bits en mémoire, lignes stockées dans
+//    l'ordre du fichier (de bas en haut si top_down est nul) et complétées
+//    par leur bourrage de stride octets.
+struct test_image {
+  int width;
+  int height;
+  int top_down;
+  size_t stride;
+  unsigned char *pixels;
+};
+
+//- PROCÉDURES DU MODULE --v---v---v---v---v---v---v---v---v---v---v---v---v---v
+
+//  main : point d'entrée du programme de test. Si un répertoire est donné en
+//    argument, le corpus y est écrit et conservé (il sert alors de corpus
+//    initial au fuzzer) ; sinon il est écrit dans un répertoire temporaire
+//    supprimé en fin d'exécution. Renvoie EXIT_SUCCESS si toutes les
+//    vérifications ont réussi, EXIT_FAILURE sinon.
+int main(int argc, char *argv[]);
+
+#endif
@@ -6,7 +6,9 @@
 #include <sys/shm.h>
 #include <pthread.h>
 #include <fcntl.h>
+#include <errno.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 #include "worker.h"
 #include "image_ops.h"
@@ -20,81 +22,248 @@ void *thread_filter_task(void *arg) {
   switch (ws->filtre) {
     case FILTER_GRAYSCALE:
       apply_grayscale_filter(ws->pixel_data_ptr, width, height,
-          ws->ligne_debut, ws->ligne_fin);
+          ws->ligne_debut, ws->ligne_fin, ws->colonne_debut, ws->colonne_fin);
       break;
     case FILTER_NEGATIVE:
       apply_negative_filter(ws->pixel_data_ptr, width,
-          ws->ligne_debut, ws->ligne_fin);
+          ws->ligne_debut, ws->ligne_fin, ws->colonne_debut, ws->colonne_fin);
       break;
     case FILTER_BRIGHTNESS:
+      apply_brightness_filter(ws->pixel_data_ptr, width,
+          ws->ligne_debut, ws->ligne_fin, ws->colonne_debut, ws->colonne_fin,
+          BRIGHTNESS_ADJUSTMENT);
+      break;
+    default:
+      fprintf(stderr, "Thread %d: Filtre %d inconnu.\n", ws->thread_id,
+          ws->filtre);
+  }
+  pthread_exit(nullptr);
+}
+
+//- RÉPONSES --v---v---v---v---v---v---v---v---v---v---v---v---v---v---v---v---v
+
+int send_reply_status(pid_t client_pid, int status) {
+  char fifo_path[256];
+  snprintf(fifo_path, sizeof(fifo_path), "%s%d", FIFO_REP_PATH, client_pid);
+  int fd_fifo = open(fifo_path, O_WRONLY | O_NONBLOCK);
+  if (fd_fifo == -1) {
+    perror("Erreur ouverture FIFO (réponse)");
+    return -1;
+  }
+  struct filter_reply reply = { .status = status };
+  ssize_t ret = write(fd_fifo, &reply, sizeof(reply));
+  close(fd_fifo);
+  if (ret != (ssize_t) sizeof(reply)) {
+    perror("Erreur write reply");
+    return -1;
+  }
+  return 0;
+}
+
+//- GÉOMÉTRIE ET ENVOI --v---v---v---v---v---v---v---v---v---v---v---v---v---v-
+
+//  apply_geometry : applique sur place le demi-tour ou le miroir demandé par
+//    geometrie. Pour un quart de tour, remplace *img_ptr et *pixels_ptr par
+//    un nouveau segment et détache l'ancien. Renvoie REPLY_OK en cas de
+//    succès, REPLY_BUSY si le segment de destination n'a pu être alloué et
+//    REPLY_INVALID si geometrie n'est pas une valeur GEOM_* connue.
+static int apply_geometry(int geometrie, struct image_data **img_ptr,
+    char **pixels_ptr) {
+  int width = (*img_ptr)->info_header.biWidth;
+  int height = abs((*img_ptr)->info_header.biHeight);
+  switch (geometrie) {
+    case GEOM_ROTATE_90:
+    case GEOM_ROTATE_270:
       {
-        int adj = 50;
-        for (int y = ws->ligne_debut; y < ws->ligne_fin; y++) {
-          for (int x = 0; x < width; x++) {
-            Pixel *p = &ws->pixel_data_ptr[y * width + x];
-            int r = (int) p->red + adj;
-            int g = (int) p->green + adj;
-            int b = (int) p->blue + adj;
-            p->red = (unsigned char) (r > 255 ? 255 : (r < 0 ? 0 : r));
-            p->green = (unsigned char) (g > 255 ? 255 : (g < 0 ? 0 : g));
-            p->blue = (unsigned char) (b > 255 ? 255 : (b < 0 ? 0 : b));
-          }
+        struct image_data *rotated_img;
+        char *rotated_pixels;
+        int rotated_size;
+        if (rotate_bmp_image(*img_ptr, *pixels_ptr,
+            geometrie == GEOM_ROTATE_90, &rotated_img, &rotated_pixels,
+            &rotated_size) != 0) {
+          return REPLY_BUSY;
         }
+        shmdt(*img_ptr);
+        *img_ptr = rotated_img;
+        *pixels_ptr = rotated_pixels;
         break;
       }
+    case GEOM_ROTATE_180:
+      flip_pixels(*pixels_ptr, width, height, 1, 1);
+      break;
+    case GEOM_FLIP_H:
+      flip_pixels(*pixels_ptr, width, height, 1, 0);
+      break;
+    case GEOM_FLIP_V:
+      flip_pixels(*pixels_ptr, width, height, 0, 1);
+      break;
+    case GEOM_NONE:
+    case GEOM_CROP:
+      break;
     default:
-      fprintf(stderr, "Thread %d: Filtre %d inconnu.\n", ws->thread_id,
-          ws->filtre);
+      return REPLY_INVALID;
   }
-  pthread_exit(nullptr);
+  return REPLY_OK;
+}
+
+//  SEND_IOV_ROWS : nombre de lignes regroupées par appel à writev lors de
+//    l'envoi d'une zone recadrée.
+#define SEND_IOV_ROWS 256
+
+//  send_image_region : écrit dans fd_fifo les en-têtes BMP décrivant la zone
+//    [ligne_debut, ligne_fin) x [colonne_debut, colonne_fin) de l'image img,
+//    puis les lignes correspondantes lues directement dans le segment SHM et
+//    complétées par leur bourrage. Une zone couvrant toute la largeur est
+//    contiguë et part en une seule écriture. Renvoie 0 en cas de succès, -1
+//    sinon.
+static int send_image_region(int fd_fifo, const struct image_data *img,
+    const char *pixels, int ligne_debut, int ligne_fin, int colonne_debut,
+    int colonne_fin) {
+  int width = img->info_header.biWidth;
+  int out_width = colonne_fin - colonne_debut;
+  int out_height = ligne_fin - ligne_debut;
+  size_t src_stride = ((size_t) width * 3 + 3) & ~(size_t) 3;
+  size_t out_row = (size_t) out_width * 3;
+  size_t out_stride = (out_row + 3) & ~(size_t) 3;
+  BMPFileHeader file_header = img->file_header;
+  BMPInfoHeader info_header = img->info_header;
+  file_header.bfOffBits = sizeof(BMPFileHeader) + sizeof(BMPInfoHeader);
+  info_header.biSize = sizeof(BMPInfoHeader);
+  info_header.biWidth = out_width;
+  info_header.biHeight = img->info_header.biHeight > 0 ? out_height
+      : -out_height;
+  info_header.biSizeImage = (uint32_t) (out_stride * (size_t) out_height);
+  file_header.bfSize = file_header.bfOffBits + info_header.biSizeImage;
+  if (write(fd_fifo, &file_header, sizeof(file_header)) < 0
+      || write(fd_fifo, &info_header, sizeof(info_header)) < 0) {
+    perror("Erreur write headers");
+    return -1;
+  }
+  const char *first = pixels + (size_t) ligne_debut * src_stride
+      + (size_t) colonne_debut * 3;
+  if (colonne_debut == 0 && colonne_fin == width) {
+    if (write(fd_fifo, first, src_stride * (size_t) out_height) < 0) {
+      perror("Erreur write pixels");
+      return -1;
+    }
+    return 0;
+  }
+  static const char padding[3] = { 0 };
+  struct iovec iov[2 * SEND_IOV_ROWS];
+  for (int y = 0; y < out_height; ) {
+    int n = 0;
+    for (; y < out_height && n < 2 * SEND_IOV_ROWS; y++) {
+      iov[n].iov_base = (void *) (first + (size_t) y * src_stride);
+      iov[n++].iov_len = out_row;
+      if (out_stride > out_row) {
+        iov[n].iov_base = (void *) padding;
+        iov[n++].iov_len = out_stride - out_row;
+      }
+    }
+    if (writev(fd_fifo, iov, n) < 0) {
+      perror("Erreur write pixels");
+      return -1;
+    }
+  }
+  return 0;
 }
 
 //- LOGIQUE DU PROCESSUS --v---v---v---v---v---v---v---v---v---v---v---v---v---v
 
-void worker_process(struct filter_request req) {
+void worker_process(struct filter_request req, int num_threads) {
   struct image_data *img_shm_ptr = nullptr;
   char *pixel_data_base_ptr = nullptr;
   int total_shm_size = 0;
-  if (load_bmp_image(req.chemin, &img_shm_ptr, &pixel_data_base_ptr,
-        &total_shm_size) != 0) {
+  if (req.filtre < FILTER_NONE || req.filtre > FILTER_BRIGHTNESS) {
+    fprintf(stderr, "Worker[%d]: Filtre %d inconnu.\n", getpid(), req.filtre);
+    send_reply_status(req.pid, REPLY_INVALID);
+    return;
+  }
+  int loaded = load_bmp_image(req.chemin, &img_shm_ptr, &pixel_data_base_ptr,
+      &total_shm_size);
+  if (loaded != 0) {
     fprintf(stderr, "Worker[%d]: Erreur chargement %s\n", getpid(), req.chemin);
+    send_reply_status(req.pid,
+        loaded == LOAD_NO_MEMORY ? REPLY_BUSY : REPLY_INVALID);
+    return;
+  }
+  int status = apply_geometry(req.geometrie, &img_shm_ptr,
+      &pixel_data_base_ptr);
+  if (status != REPLY_OK) {
+    fprintf(stderr, "Worker[%d]: Erreur transformation %d\n", getpid(),
+        req.geometrie);
+    shmdt(img_shm_ptr);
+    send_reply_status(req.pid, status);
     return;
   }
+  int width = img_shm_ptr->info_header.biWidth;
   int height = abs(img_shm_ptr->info_header.biHeight);
-  int rows_per_thread = height / NUM_THREADS;
-  pthread_t threads[NUM_THREADS];
-  struct thread_workspace workspaces[NUM_THREADS];
-  for (int i = 0; i < NUM_THREADS; i++) {
-    workspaces[i].thread_id = i;
-    workspaces[i].shm_img = img_shm_ptr;
-    workspaces[i].pixel_data_ptr = (Pixel *) pixel_data_base_ptr;
-    workspaces[i].filtre = req.filtre;
-    workspaces[i].ligne_debut = i * rows_per_thread;
-    workspaces[i].ligne_fin = (i
-        == NUM_THREADS - 1) ? height : (i + 1) * rows_per_thread;
-    pthread_create(&threads[i], nullptr, thread_filter_task, &workspaces[i]);
+  int ligne_debut = 0;
+  int ligne_fin = height;
+  int colonne_debut = 0;
+  int colonne_fin = width;
+  if (req.geometrie == GEOM_CROP) {
+    long x = req.parametres[0];
+    long y = req.parametres[1];
+    long w = req.parametres[2];
+    long h = req.parametres[3];
+    if (x < 0 || y < 0 || w <= 0 || h <= 0 || x + w > width
+        || y + h > height) {
+      fprintf(stderr, "Worker[%d]: Recadrage hors de l'image.\n", getpid());
+      shmdt(img_shm_ptr);
+      send_reply_status(req.pid, REPLY_INVALID);
+      return;
+    }
+    colonne_debut = (int) x;
+    colonne_fin = (int) (x + w);
+    if (img_shm_ptr->info_header.biHeight > 0) {
+      ligne_debut = (int) (height - y - h);
+      ligne_fin = (int) (height - y);
+    } else {
+      ligne_debut = (int) y;
+      ligne_fin = (int) (y + h);
+    }
   }
-  for (int i = 0; i < NUM_THREADS; i++) {
-    pthread_join(threads[i], nullptr);
+  if (req.filtre != FILTER_NONE) {
+    if (num_threads < 1 || num_threads > THREADS_LIMIT) {
+      num_threads = NUM_THREADS;
+    }
+    int rows_per_thread = (ligne_fin - ligne_debut) / num_threads;
+    pthread_t threads[THREADS_LIMIT];
+    struct thread_workspace workspaces[THREADS_LIMIT];
+    for (int i = 0; i < num_threads; i++) {
+      workspaces[i].thread_id = i;
+      workspaces[i].shm_img = img_shm_ptr;
+      workspaces[i].pixel_data_ptr = (Pixel *) pixel_data_base_ptr;
+      workspaces[i].filtre = req.filtre;
+      workspaces[i].ligne_debut = ligne_debut + i * rows_per_thread;
+      workspaces[i].ligne_fin = (i == num_threads - 1)
+          ? ligne_fin : ligne_debut + (i + 1) * rows_per_thread;
+      workspaces[i].colonne_debut = colonne_debut;
+      workspaces[i].colonne_fin = colonne_fin;
+      pthread_create(&threads[i], nullptr, thread_filter_task, &workspaces[i]);
+    }
+    for (int i = 0; i < num_threads; i++) {
+      pthread_join(threads[i], nullptr);
+    }
   }
   char fifo_path[256];
   snprintf(fifo_path, sizeof(fifo_path), "%s%d", FIFO_REP_PATH, req.pid);
-  int fd_fifo = open(fifo_path, O_WRONLY);
+  int fd_fifo = open(fifo_path, O_WRONLY | O_NONBLOCK);
   if (fd_fifo != -1) {
-    ssize_t ret;
-    ret = write(fd_fifo, &(img_shm_ptr->file_header), sizeof(BMPFileHeader));
-    if (ret < 0) {
-      perror("Erreur write file_header");
-    }
-    ret = write(fd_fifo, &(img_shm_ptr->info_header), sizeof(BMPInfoHeader));
-    if (ret < 0) {
-      perror("Erreur write info_header");
-    }
-    ret = write(fd_fifo, pixel_data_base_ptr, (size_t) img_shm_ptr->data_size);
-    if (ret < 0) {
-      perror("Erreur write pixels");
+    int flags = fcntl(fd_fifo, F_GETFL, 0);
+    fcntl(fd_fifo, F_SETFL, flags & ~O_NONBLOCK);
+    struct filter_reply reply = { .status = REPLY_OK };
+    if (write(fd_fifo, &reply, sizeof(reply)) < 0) {
+      perror("Erreur write reply");
+    } else {
+      send_image_region(fd_fifo, img_shm_ptr, pixel_data_base_ptr,
+          ligne_debut, ligne_fin, colonne_debut, colonne_fin);
     }
     close(fd_fifo);
+  } else if (errno == ENXIO) {
+    fprintf(stderr, "Worker[%d]: Client %d disparu, image abandonnée.\n",
+        getpid(), req.pid);
   } else {
     perror("Worker: Erreur ouverture FIFO");
   }
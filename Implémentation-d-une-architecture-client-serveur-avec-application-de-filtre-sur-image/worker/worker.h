@@ -4,11 +4,16 @@
 //  Fonctionnement général :
 //  - le module assure le traitement d'une image BMP chargée en mémoire partagée
 //      privée (SHM) pour garantir l'isolation des données entre processus ;
+//  - une transformation géométrique optionnelle (rotation, miroir) est
+//      appliquée avant le filtrage ; un recadrage réduit simplement la zone
+//      traitée et transmise ;
 //  - le parallélisme est mis en œuvre par un découpage de l'image en bandes
 //      horizontales, chaque bande étant traitée par un thread POSIX distinct ;
-//  - le nombre de threads utilisés est défini par la macro NUM_THREADS ;
+//  - le nombre de threads utilisés est fourni par le serveur (NUM_THREADS par
+//      défaut, THREADS_LIMIT au plus) ;
 //  - une fois le traitement achevé, les données (en-têtes et pixels) sont
-//      transmises de manière séquentielle vers le tube nommé (FIFO) du client ;
+//      transmises de manière séquentielle vers le tube nommé (FIFO) du client,
+//      précédées d'une struct filter_reply de statut REPLY_OK ;
 //  - les fonctions du module vérifient systématiquement les retours des appels
 //      système (write, open, shm, etc.) et signalent les erreurs sur stderr.
 
@@ -23,24 +28,44 @@
 //    parallèle de l'image. Par défaut fixé à 8.
 #define NUM_THREADS 8
 
+//  THREADS_LIMIT : nombre maximal de threads par Worker.
+#define THREADS_LIMIT 64
+
 //  load_bmp_image : tente de charger l'image située au chemin path dans un
 //    segment de mémoire partagée. Affecte l'adresse du contrôleur à *img_ptr,
 //    l'adresse des pixels à *pixel_data_ptr et la taille totale à
-//    total_shm_size. Renvoie 0 en cas de succès, une valeur non nulle sinon.
+//    total_shm_size. Renvoie 0 en cas de succès, LOAD_NO_MEMORY si le segment
+//    n'a pu être alloué, -1 si le fichier est invalide.
 extern int load_bmp_image(const char *path, struct image_data **img_ptr,
     char **pixel_data_ptr, int *total_shm_size);
 
+//  BRIGHTNESS_ADJUSTMENT : valeur ajoutée à chaque composante par le filtre
+//    FILTER_BRIGHTNESS.
+#define BRIGHTNESS_ADJUSTMENT 50
+
 //  apply_grayscale_filter : applique la transformation en niveaux de gris sur
-//    la plage de lignes comprise entre start_row et end_row (exclue) pour
-//    l'image pointée par pixels de dimensions width x height.
+//    la plage de lignes comprise entre start_row et end_row (exclue) et de
+//    colonnes entre start_col et end_col (exclue) pour l'image pointée par
+//    pixels de dimensions width x height.
 extern void apply_grayscale_filter(Pixel *pixels, int width, int height,
-    int start_row, int end_row);
+    int start_row, int end_row, int start_col, int end_col);
 
 //  worker_process : point d'entrée principal du processus ouvrier. Récupère
-//    les ressources SHM, orchestre la création et la synchronisation des
-//    threads de filtrage définis par req.filtre, puis transmet l'image
-//    résultante via la FIFO associée au PID du client demandeur.
-extern void worker_process(struct filter_request req);
+//    les ressources SHM, applique la transformation req.geometrie, orchestre
+//    la création et la synchronisation des num_threads threads de filtrage
+//    définis par req.filtre, puis transmet l'image résultante via la FIFO
+//    associée au PID du client demandeur. Un recadrage restreint les bandes
+//    confiées aux threads et la zone transmise, sans copie de l'image. La
+//    FIFO est ouverte sans blocage : si le client a disparu sans que
+//    personne ne la lise, l'image est abandonnée. Un filtre ou une
+//    transformation inconnus sont refusés par REPLY_INVALID.
+extern void worker_process(struct filter_request req, int num_threads);
+
+//  send_reply_status : ouvre sans blocage la FIFO du client client_pid et y
+//    écrit une struct filter_reply portant status. Utilisée pour signaler un
+//    refus ou un échec sans données d'image. Renvoie 0 en cas de succès, -1 si
+//    le client n'écoute plus ou si l'écriture échoue.
+extern int send_reply_status(pid_t client_pid, int status);
 
 //  thread_filter_task : routine de démarrage pour les threads POSIX. Interprète
 //    le paramètre arg comme un pointeur vers un thread_workspace pour